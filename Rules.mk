@@ -4,15 +4,16 @@ else
  CXX11FLAG = -std=c++11
 endif
 
-TARGETS := main.out
+TARGETS := main.out merge.out
 SUBDIRS := std_libs
 
 SRCS := *.cpp
 
-CXXFLAGS := -g $(CXX11FLAG)
+CXXFLAGS := -g $(CXX11FLAG) -pthread
 CFLAGS := -g -Wall -W -Os
 
-main.out_DEPS = $(OBJS_$(d)) $(TARGETS_$(d)/std_libs)
+main.out_DEPS = $(filter-out %/shard.merge.o,$(OBJS_$(d))) $(TARGETS_$(d)/std_libs)
+merge.out_DEPS = $(filter-out %/hopping.large.nt.o,$(OBJS_$(d))) $(TARGETS_$(d)/std_libs)
 
 ifeq ($(BUILD_MODE),release)
 	CXXFLAGS += -DNDEBUG
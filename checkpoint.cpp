@@ -0,0 +1,204 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 14:05:31 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#include"checkpoint.hpp"
+
+#include<fstream>
+#include<vector>
+#include<iterator>
+#include<cstdio>
+
+#include<boost/multiprecision/cpp_int.hpp>
+
+namespace hop {
+
+/* ============================================================================================================================
+ * Small anonymous helper functions to be used by the following functions
+ * ============================================================================================================================ */
+
+namespace{
+
+const char checkpoint_magic[8] = {'H','L','N','T','C','K','P','2'};
+
+void write_unsigned(std::ostream & os, std::uint64_t x)
+{
+  while(x >= 0x80) {
+    os.put(static_cast<char>( (x & 0x7f) | 0x80 ));
+    x >>= 7;
+  }
+
+  os.put(static_cast<char>(x));
+}
+
+std::uint64_t read_unsigned(std::istream & is)
+{
+  std::uint64_t result = 0;
+
+  for(int shift = 0; shift < 64; shift += 7) {
+    int byte = is.get();
+
+    if(byte == std::char_traits<char>::eof())
+      throw CheckpointError("Unexpected end of file while reading a checkpoint");
+
+    result |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+
+    if( (byte & 0x80) == 0 )
+      return result;
+  }
+
+  throw CheckpointError("Malformed integer while reading a checkpoint");
+}
+
+void write_signed(std::ostream & os, std::int64_t x)
+{
+  write_unsigned(os, (static_cast<std::uint64_t>(x) << 1) ^ static_cast<std::uint64_t>(x >> 63));
+}
+
+std::int64_t read_signed(std::istream & is)
+{
+  std::uint64_t u = read_unsigned(is);
+  return static_cast<std::int64_t>(u >> 1) ^ -static_cast<std::int64_t>(u & 1);
+}
+
+void write_integer(std::ostream & os, const PM::pref_type & x)
+{
+  std::vector<unsigned char> bytes;
+  PM::pref_type magnitude = abs(x);
+  boost::multiprecision::export_bits(magnitude, std::back_inserter(bytes), 8);
+
+  write_unsigned(os, (x < 0) ? 1 : 0);
+  write_unsigned(os, bytes.size());
+  os.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+}
+
+PM::pref_type read_integer(std::istream & is)
+{
+  bool negative = read_unsigned(is) != 0;
+  std::vector<unsigned char> bytes(read_unsigned(is));
+
+  is.read(reinterpret_cast<char *>(bytes.data()), bytes.size());
+
+  if(!is)
+    throw CheckpointError("Unexpected end of file while reading a checkpoint");
+
+  PM::pref_type result = 0;
+
+  if(!bytes.empty())
+    boost::multiprecision::import_bits(result, bytes.begin(), bytes.end(), 8);
+
+  return negative ? PM::pref_type(-result) : result;
+}
+
+}; //Anonymous namespace
+
+void WriteTerms(std::ostream & os, const std::list<WilsonString> & terms)
+{
+  write_unsigned(os, terms.size());
+
+  for(const WilsonString & ws : terms) {
+    write_signed(os, ws.number_of_traces);
+    write_integer(os, ws.prefactor.numerator());
+    write_integer(os, ws.prefactor.denominator());
+
+    write_unsigned(os, ws.wilsons.size());
+
+    for(const Wilson & w : ws.wilsons) {
+      write_unsigned(os, w.n);
+      write_unsigned(os, w.m);
+
+      write_unsigned(os, w.pos.size());
+      for(int x : w.pos)
+        write_signed(os, x);
+    }
+  }
+}
+
+void ReadTerms(std::istream & is, std::list<WilsonString> & terms)
+{
+  std::uint64_t number_of_terms = read_unsigned(is);
+
+  for(std::uint64_t i = 0; i < number_of_terms; ++i) {
+
+    terms.emplace_back();
+    WilsonString & ws = terms.back();
+
+    ws.number_of_traces = read_signed(is);
+
+    PM::pref_type numerator = read_integer(is);
+    PM::pref_type denominator = read_integer(is);
+    ws.prefactor.assign(numerator, denominator);
+
+    ws.wilsons.resize(read_unsigned(is));
+
+    for(Wilson & w : ws.wilsons) {
+      w.n = read_unsigned(is);
+      w.m = read_unsigned(is);
+
+      std::vector<int> components(read_unsigned(is));
+      for(int & x : components)
+        x = read_signed(is);
+
+      w.pos = Position::pos(components.begin(), components.end());
+    }
+  }
+}
+
+/// Writes the checkpoint to a temporary file which is then renamed, so that an interruption while saving never
+/// destroys the previous checkpoint.
+
+void Checkpoint::Save(const std::string & filename, const std::list<WilsonString> & terms) const
+{
+  std::string tmp_filename = filename + ".tmp";
+
+  {
+    std::ofstream out(tmp_filename, std::ios::binary | std::ios::trunc);
+
+    if(!out)
+      throw CheckpointError("Unable to open the checkpoint file for writing");
+
+    out.write(checkpoint_magic, sizeof(checkpoint_magic));
+
+    write_signed(out, order);
+    write_signed(out, shard_index);
+    write_signed(out, shard_count);
+    write_unsigned(out, number_of_configs);
+    write_unsigned(out, configs_done);
+    write_unsigned(out, debug_offset);
+
+    WriteTerms(out, terms);
+
+    out.flush();
+
+    if(!out)
+      throw CheckpointError("Failed to write the checkpoint file");
+  }
+
+  if(std::rename(tmp_filename.c_str(), filename.c_str()) != 0)
+    throw CheckpointError("Unable to move the temporary checkpoint file into place");
+}
+
+void Checkpoint::Load(const std::string & filename, std::list<WilsonString> & terms)
+{
+  std::ifstream in(filename, std::ios::binary);
+
+  if(!in)
+    throw CheckpointError("Unable to open the checkpoint file for reading");
+
+  char magic[sizeof(checkpoint_magic)];
+  in.read(magic, sizeof(magic));
+
+  if( !in or !std::equal(magic, magic + sizeof(magic), checkpoint_magic) )
+    throw CheckpointError("The file is not a checkpoint file");
+
+  order = read_signed(in);
+  shard_index = read_signed(in);
+  shard_count = read_signed(in);
+  number_of_configs = read_unsigned(in);
+  configs_done = read_unsigned(in);
+  debug_offset = read_unsigned(in);
+
+  ReadTerms(in, terms);
+}
+
+} //Namespace hop
@@ -0,0 +1,58 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 14:05:31 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include<iostream>
+#include<string>
+#include<list>
+#include<cstdint>
+
+#include"std_libs/error.h"
+#include"pm.wilson.h"
+
+namespace hop {
+
+//// Functions which write and read a list of WilsonStrings in a compact binary format. All integers are stored as
+//// variable length integers (7 bits per byte), with signed ones zig-zag encoded, and the arbitrary precision
+//// prefactors are stored as a sign followed by their magnitude in bytes.
+
+void WriteTerms(std::ostream & os, const std::list<WilsonString> & terms);
+void ReadTerms(std::istream & is, std::list<WilsonString> & terms);
+
+//// The state of an interrupted PMN::streamPaths run. It stores how many of the configurations of the highest order
+//// have been printed and collected, the size of the .debug file at that point, and the collected terms so far.
+//// The order, shard and the total number of configurations are stored to make sure a checkpoint is not resumed by a
+//// different run. The terms are passed separately so that they do not have to be copied out of the collector.
+////
+//// A finished shard of a sharded run stores its partial result in the same format, with configs_done equal to
+//// number_of_configs, which is what the shard-merge tool reads.
+
+struct Checkpoint
+{
+  int order;
+  int shard_index;
+  int shard_count;
+  std::uint64_t number_of_configs;
+  std::uint64_t configs_done;
+  std::uint64_t debug_offset;
+
+  Checkpoint() : order(0), shard_index(0), shard_count(1), number_of_configs(0), configs_done(0), debug_offset(0) {};
+
+  bool is_complete() const {return configs_done == number_of_configs;};
+
+  void Save(const std::string & filename, const std::list<WilsonString> & terms) const;
+  void Load(const std::string & filename, std::list<WilsonString> & terms);
+};
+
+class CheckpointError : public Error
+{
+public:
+  CheckpointError(const char *inerr) : Error(inerr,"checkpoint") {};
+};
+
+} //Namespace hop
+
+#endif /* CHECKPOINT_HPP */
@@ -22,19 +22,23 @@ void TermCollector::pathCollector(PMPath * object)
   for(WilsonString & w_term : object->w) {
 
     w_term.prefactor *= current_config_prefactor;
+    addTerm(std::move(w_term));
+  }
+}
 
-    auto lower = std::lower_bound(
-        terms.begin(), terms.end(), 
-        w_term, StrictWilsonStringComparator() );
+void TermCollector::addTerm(WilsonString && w_term)
+{
+  auto lower = std::lower_bound(
+      terms.begin(), terms.end(), 
+      w_term, StrictWilsonStringComparator() );
 
-    if( (lower == terms.end()) or StrictWilsonStringComparator::Compare(w_term,*lower) ) {
-      terms.insert(lower, std::move(w_term) );
-    } else {
-      lower->prefactor += w_term.prefactor;
+  if( (lower == terms.end()) or StrictWilsonStringComparator::Compare(w_term,*lower) ) {
+    terms.insert(lower, std::move(w_term) );
+  } else {
+    lower->prefactor += w_term.prefactor;
 
-      if(lower->prefactor == 0)
-        terms.erase(lower);
-    }
+    if(lower->prefactor == 0)
+      terms.erase(lower);
   }
 }
 
@@ -43,6 +47,31 @@ void TermCollector::fetchResults(std::list<WilsonString> & res)
   res.splice(res.end(), std::move(terms));
 }
 
+/// Merges a list of terms, sorted by the StrictWilsonStringComparator (such as the result of fetchResults()), into
+/// the collected terms. Equal terms have their prefactors summed, and are removed if the sum is zero. As both lists
+/// are sorted this is done in a single pass. The passed list is emptied.
+
+void TermCollector::mergeResults(std::list<WilsonString> & res)
+{
+  auto it = terms.begin();
+
+  while(!res.empty()) {
+
+    while( (it != terms.end()) and StrictWilsonStringComparator::Compare(*it, res.front()) )
+      ++it;
+
+    if( (it == terms.end()) or StrictWilsonStringComparator::Compare(res.front(), *it) ) {
+      terms.splice(it, res, res.begin());
+    } else {
+      it->prefactor += res.front().prefactor;
+      res.pop_front();
+
+      if(it->prefactor == 0)
+        it = terms.erase(it);
+    }
+  }
+}
+
 bool StrictWilsonStringComparator::Compare(
     const WilsonString & lhs, 
     const WilsonString & rhs)
@@ -20,11 +20,17 @@ private:
   std::list<WilsonString> terms;
   boost::rational<PM::pref_type> current_config_prefactor;
 
+  void addTerm(WilsonString && w_term);
+
 public:
   virtual void pathCollector(PMPath * path);
   virtual void configCollector(PMConfig * object);
 
   virtual void fetchResults(std::list<WilsonString> & res);
+  virtual void mergeResults(std::list<WilsonString> & res);
+
+  const std::list<WilsonString> & peekResults() const {return terms;};
+  virtual std::size_t numberOfTerms() const {return terms.size();};
 
   virtual ~TermCollector() {};
 };
@@ -5,6 +5,8 @@
 #ifndef COLLECTOR_HPP
 #define COLLECTOR_HPP
 
+#include<cstddef>
+
 namespace hop {
 
 class PMPath;
@@ -16,6 +18,8 @@ public:
   virtual void pathCollector(PMPath * path) {};
   virtual void configCollector(PMConfig * object) {};
 
+  virtual std::size_t numberOfTerms() const {return 0;};
+
   virtual ~Collector() {};
 };
 
@@ -9,11 +9,15 @@
 #include<vector>
 #include<string>
 
+#include<chrono>
+
 #include<sys/types.h>
 #include<sys/stat.h>
+#include<unistd.h>
 using namespace std;
 
 #include<boost/lexical_cast.hpp>
+#include<boost/program_options.hpp>
 
 #define BOOST_ALL_NO_LIB 1
 
@@ -21,69 +25,236 @@ using namespace std;
 #include"pmn.h"
 
 #include"debug_printer.hpp"
-#include"json_printer.hpp"
 #include"collector.concrete.hpp"
+#include"checkpoint.hpp"
+#include"term_output.hpp"
+#include"run_statistics.hpp"
+
+namespace po = boost::program_options;
 
 int main(int argc, char** argv)
 {
 
-  if(argc < 2) {
+  int order;
+  int number_of_threads;
+  string checkpoint_filename;
+  int checkpoint_interval;
+  string shard;
+  int progress_interval;
+
+  po::options_description options("Options");
+  options.add_options()
+    ("help,h", "Print this help message")
+    ("order", po::value<int>(&order), "The order in kappa to compute")
+    ("threads,j", po::value<int>(&number_of_threads)->default_value(1),
+     "Number of threads used to fill the paths of the configurations")
+    ("stream", "Print and collect every configuration as soon as its paths are done, "
+     "freeing them before moving on. Bounds the memory by the largest configuration")
+    ("checkpoint", po::value<string>(&checkpoint_filename),
+     "Periodically save the progress to the given file (implies --stream)")
+    ("checkpoint-interval", po::value<int>(&checkpoint_interval)->default_value(600),
+     "Minimum number of seconds between two checkpoints")
+    ("resume", "Resume from the file given by --checkpoint, if it exists")
+    ("symmetry", "Map the temporal paths of configurations related by swapping p and m or reversing them from one "
+     "another, instead of running the temporal recursion for each of them")
+    ("shard", po::value<string>(&shard),
+     "Only run shard i of N, given as i/N with 0 <= i < N. The partial result is written to a .part file "
+     "which is combined with the other shards by merge.out")
+    ("progress", po::value<int>(&progress_interval)->default_value(60),
+     "Minimum number of seconds between two progress lines on stderr, 0 turns them off")
+    ("count-only", "Only count the configurations, temporal paths, spatial paths and WilsonStrings of the order, "
+     "without keeping any paths or collecting any terms");
+
+  po::positional_options_description positional;
+  positional.add("order", 1);
+
+  po::variables_map vm;
+
+  try{
+    po::store(po::command_line_parser(argc, argv).options(options).positional(positional).run(), vm);
+    po::notify(vm);
+  }catch (po::error &err) {
+    cerr << err.what() << endl;
+    return 1;
+  }
+
+  if(vm.count("help")) {
+    cout << "Usage: " << argv[0] << " N [options]" << endl << options << endl;
+    return 0;
+  }
+
+  if(!vm.count("order")) {
     cerr << "No order given" << endl;
     return 1;
   }
 
-  int order;
-  try{
-    order = boost::lexical_cast<int>(argv[1]);
-  }catch (boost::bad_lexical_cast &) {
-    cout << "The given argument, \"" << argv[1] << "\", is not a number" << endl;
+  if(number_of_threads < 1) {
+    cerr << "The number of threads must be at least one" << endl;
+    return 1;
+  }
+
+  if(vm.count("count-only") and vm.count("checkpoint")) {
+    cerr << "A count has nothing to checkpoint, --count-only cannot be combined with --checkpoint" << endl;
+    return 1;
+  }
+
+  if(vm.count("resume") and !vm.count("checkpoint")) {
+    cerr << "Cannot resume without a checkpoint file given by --checkpoint" << endl;
     return 1;
   }
 
+  int shard_index = 0, shard_count = 1;
+
+  if(vm.count("shard")) {
+    char trailing;
+    if( (sscanf(shard.c_str(), "%d/%d%c", &shard_index, &shard_count, &trailing) != 2) or
+        (shard_count < 1) or (shard_index < 0) or (shard_index >= shard_count) ) {
+      cerr << "The shard \"" << shard << "\" is not on the form i/N with 0 <= i < N" << endl;
+      return 1;
+    }
+  }
+
+  hop::RunStatistics statistics(order, number_of_threads, cerr, progress_interval);
+
   hop::PMN pmn(order);
+  pmn.setStatistics(&statistics);
   pmn.fillConfigs();
-  pmn.fillPaths();
 
-  string foldername = "Configurations";
-  { //checking if the folder exists, and create it if it doesn't
+  if(vm.count("shard"))
+    pmn.selectShard(shard_index, shard_count);
+
+  if(vm.count("symmetry"))
+    pmn.reduceSymmetries();
+
+  hop::Checkpoint checkpoint;
+  std::list<hop::WilsonString> checkpoint_terms;
+  bool resuming = false;
+
+  if(vm.count("resume")) {
     struct stat st {0};
-    if(stat(foldername.c_str(), &st) == -1)
-      mkdir(foldername.c_str(), 0755);
+
+    if(stat(checkpoint_filename.c_str(), &st) == -1) {
+      cout << "No checkpoint found at \"" << checkpoint_filename << "\", starting from the beginning" << endl;
+    } else {
+      try{
+        checkpoint.Load(checkpoint_filename, checkpoint_terms);
+      }catch (hop::CheckpointError &err) {
+        cerr << err << endl;
+        return 1;
+      }
+
+      if(checkpoint.order != order or checkpoint.number_of_configs != pmn.numberOfConfigs() or
+         checkpoint.shard_index != shard_index or checkpoint.shard_count != shard_count) {
+        cerr << "The checkpoint \"" << checkpoint_filename << "\" does not belong to this run at order " << order << endl;
+        return 1;
+      }
+
+      resuming = true;
+      cout << "Resuming from configuration " << checkpoint.configs_done << " of " << checkpoint.number_of_configs << endl;
+    }
+  }
+
+  string foldername = "Configurations";
+  hop::MakeOutputFolder(foldername);
+
+  string file_base = foldername + "/kappa" + boost::lexical_cast<string>(order);
+
+  if(vm.count("shard"))
+    file_base += ".shard" + boost::lexical_cast<string>(shard_index) + "of" + boost::lexical_cast<string>(shard_count);
+
+  //A count only writes the statistics, with the counters being the result
+  if(vm.count("count-only")) {
+    hop::PathCount count = pmn.countPaths(number_of_threads);
+
+    statistics.finish();
+    statistics.WriteToFile(file_base + ".stats.json");
+
+    cout << "order " << order << endl
+         << "configurations " << pmn.numberOfConfigs() << endl
+         << "paths " << count.paths << endl
+         << "spatial_paths " << count.spatial_paths << endl
+         << "wilson_strings " << count.wilson_strings << endl;
+
+    return 0;
   }
 
-  string filename = foldername + "/kappa" + boost::lexical_cast<string>(order) + ".debug";
+  string filename = file_base + ".debug";
 
   ofstream out;
-  out.open(filename);
+
+  //When resuming, everything written to the debug file after the checkpoint is thrown away
+  if(resuming and truncate(filename.c_str(), checkpoint.debug_offset) == 0) {
+    out.open(filename, ios::in | ios::out);
+    out.seekp(0, ios::end);
+  } else {
+    out.open(filename);
+  }
 
   hop::DebugPrinter debug_printer(out, new Position::SymbolPrinter(out));
-  pmn.print(debug_printer);
+  hop::TermCollector collector;
 
-  out.close();
+  if(resuming)
+    collector.mergeResults(checkpoint_terms);
 
-  hop::TermCollector collector;
-  pmn.collect(collector);
+  if(vm.count("checkpoint")) {
+    auto last_saved = std::chrono::steady_clock::now();
 
-  std::list<hop::WilsonString> terms;
-  collector.fetchResults(terms);
+    auto save_checkpoint = [&](std::size_t configs_done) {
+      auto now = std::chrono::steady_clock::now();
+
+      if( (configs_done != pmn.numberOfConfigs()) and 
+          (now - last_saved < std::chrono::seconds(checkpoint_interval)) )
+        return;
 
-  filename = foldername + "/kappa" + boost::lexical_cast<string>(order) + ".terms";
+      out.flush();
 
-  out.open(filename);
-  hop::DebugPrinter term_printer(out, new Position::SymbolPrinter(out));
+      checkpoint.order = order;
+      checkpoint.shard_index = shard_index;
+      checkpoint.shard_count = shard_count;
+      checkpoint.number_of_configs = pmn.numberOfConfigs();
+      checkpoint.configs_done = configs_done;
+      checkpoint.debug_offset = out.tellp();
+      checkpoint.Save(checkpoint_filename, collector.peekResults());
 
-  for(const hop::WilsonString & w : terms)
-    w.print(term_printer);
+      last_saved = now;
+    };
+
+    pmn.streamPaths(debug_printer, collector, number_of_threads,
+                    resuming ? checkpoint.configs_done : 0, save_checkpoint);
+  } else if(vm.count("stream")) {
+    pmn.streamPaths(debug_printer, collector, number_of_threads);
+  } else {
+    pmn.fillPaths(number_of_threads);
+    pmn.print(debug_printer);
+    pmn.collect(collector);
+  }
 
   out.close();
 
-  filename = foldername + "/kappa" + boost::lexical_cast<string>(order) + ".json";
+  //The per-stage breakdown of the run, written next to the other output files
+  statistics.finish();
+  statistics.WriteToFile(file_base + ".stats.json");
 
-  hop::JSONPrinter json_printer;
+  //A shard only stores its partial result, which is combined with the others by merge.out
+  if(vm.count("shard")) {
+    hop::Checkpoint shard_result;
+    shard_result.order = order;
+    shard_result.shard_index = shard_index;
+    shard_result.shard_count = shard_count;
+    shard_result.number_of_configs = pmn.numberOfConfigs();
+    shard_result.configs_done = pmn.numberOfConfigs();
 
-  for(const hop::WilsonString & ws : terms)
-    ws.print(json_printer);
+    shard_result.Save(file_base + ".part", collector.peekResults());
+    return 0;
+  }
 
-  json_printer.WriteToFile(filename);
+  std::list<hop::WilsonString> terms;
+  collector.fetchResults(terms);
+
+  {
+    hop::RunStatistics::StageTimer timer(&statistics, hop::RunStatistics::TermOutput);
+    hop::PrintTermFiles(file_base, terms);
+  }
 
+  statistics.WriteToFile(file_base + ".stats.json");
 }
@@ -9,11 +9,13 @@
 #include<algorithm>
 
 #include<cstdlib>
+#include<cstdint>
 
 #include<vector>
 #include<list>
 #include<map>
 #include<array>
+#include<functional>
 #include<initializer_list>
 
 #include<boost/rational.hpp>
@@ -29,6 +31,11 @@
 
 #include"collector.hpp"
 #include"printers.hpp"
+#include"temporal_memo.hpp"
+
+namespace Utility {
+class TaskPool;
+}
 
 namespace hop{
 
@@ -37,6 +44,26 @@ using namespace Debug_Space;
 
 class PMN;
 
+//// The number of temporal paths, spatial paths and WilsonStrings of one or more configurations, see
+//// PMConfig::countPaths()
+
+struct PathCount
+{
+	std::uint64_t paths;
+	std::uint64_t spatial_paths;
+	std::uint64_t wilson_strings;
+
+	PathCount() : paths(0), spatial_paths(0), wilson_strings(0) {};
+
+	PathCount& operator+=(const PathCount &rhs)
+	{
+		paths += rhs.paths;
+		spatial_paths += rhs.spatial_paths;
+		wilson_strings += rhs.wilson_strings;
+		return *this;
+	};
+};
+
 /* ====================================================================================================================================
  * A class containing a possible configuration of Ps and Ms, with a vector of all possible space-time paths of the saved configuration.
  * The class also contains an array saving possible gamma-matrix configurations [to be coded].
@@ -104,6 +131,7 @@ public:
 
 	int getLen() const {return cfgArray.size();};
 	int numberOfTraces() const {return trace_points.size();};
+	const std::vector<int>& tracePoints() const {return trace_points;};
 	bool is_single() const {return (trace_points.size() <= 1);};
 
 	std::list<PMPath>::const_iterator pbegin() const {return paths.begin();};
@@ -145,12 +173,30 @@ public:
 	 * restricted spatial paths, and finding duplicated of spatial paths. Implemented in pm.config.path.cpp
 	 */
 
-	void populatePaths();
+	void populatePaths(Utility::TaskPool *pool = nullptr);
+	void populatePaths(const std::list< std::vector<int> > &image_links, const std::vector<int> &position_map);
+	void temporalLinks(std::list< std::vector<int> > &links) const;
+
+	void complete_single_trace(PMPath&);
+	void complete_multi_trace(PMPath&);
+
+	//Finds the spatial paths of a single path and packs them
+	void complete_path(PMPath &p)
+	{
+		if(is_single()){complete_single_trace(p);}else{complete_multi_trace(p);}
+
+		p.compact();
+	};
+
+	void fill_delta()
+	{
+		for(PMPath &p : paths)
+			complete_path(p);
+	};
 
-	void complete_single_trace();
-	void complete_multi_trace();
+	PathCount countPaths();
 
-	void fill_delta() {if(is_single()){complete_single_trace();}else{complete_multi_trace();}};
+	void releasePaths() {paths.clear();};
 
 	void gaugeIntegrate()
   {
@@ -178,7 +224,55 @@ public:
 	
 private:
 
-	void temporal_connections(int,int,std::vector<char>&,int); 
+	void fill_temporal(Utility::TaskPool *pool = nullptr);
+	void map_temporal(const std::list< std::vector<int> > &image_links, const std::vector<int> &position_map);
+
+	//The link ids of a partially linked path in the temporal recursion, which uses a 64 bit mask for the used points
+	static const int max_temporal_length = 64;
+	typedef std::array<int, max_temporal_length> LinkArray;
+
+	//Receives the links of every complete path found by the temporal recursion
+	typedef std::function<void(const LinkArray&)> LinkSink;
+
+	void check_temporal_length() const;
+
+	//// The groups of traces which are connected by the links of a partially linked path, together with the
+	//// displacement of every trace relative to the root of its group and the number of unlinked points left in every
+	//// group. Used to cut the temporal recursion of multi-trace configurations, implemented in pm.config.path.cpp
+	class TraceForest
+	{
+	private:
+		static const int max_traces = max_temporal_length/2;
+
+		int number_of_traces;
+
+		std::array<std::int8_t, max_temporal_length> point_trace, point_height;
+
+		std::array<std::int8_t, max_traces> root, size, open;
+		std::array<int, max_traces> offset;
+
+	public:
+		TraceForest() : number_of_traces(0) {};
+		TraceForest(const std::vector<Config>&, const std::vector<int>&);
+
+		bool link(int,int);
+	};
+
+	void temporal_connections(int,std::uint64_t,LinkArray&,int,const TraceForest&,const LinkSink&);
+	void temporal_connections_split(int,std::uint64_t,LinkArray&,int,const TraceForest&,std::list<PMPath>&,
+			Utility::TaskPool&,int);
+
+	//The links of substrings whose points are all unused, shared between all configurations. Only substrings of a
+	//length in [memo_min_length, memo_max_length] are stored, the shorter ones are quicker to enumerate than to look
+	//up, and the longer ones are rarely seen twice.
+	static TemporalMemo temporal_memo;
+	static const int memo_min_length = 6;
+	static const int memo_max_length = 16;
+
+	void substring_connections(int,int,LinkArray&,const LinkSink&);
+
+	//How many levels of the temporal recursion are split into separate tasks when running on a TaskPool
+	static const int parallel_split_depth = 3;
 	void spatial_contractions_full(int from, int to, PMPath &path, std::vector<char> &used);
 	void positional_delta(int,int,PMPath&);
 
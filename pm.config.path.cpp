@@ -4,6 +4,7 @@
 //Description: Implementation of the functions directly related to the paths
 
 #include"pm.config.h"
+#include"std_libs/task_pool.hpp"
 
 namespace hop{
 
@@ -19,6 +20,24 @@ bool no_open_links_exist_between(std::vector<char> &used, int from, int to){
   return open_in_used or (to-from < 3);
 }
 
+/// The order in which temporal_connections creates a set of links: for every link, in the order of their starting
+/// points, the position of its end point. Sorting on this key puts paths in the order of the recursion.
+
+std::vector<int> link_ends(const std::vector<int> &path){
+
+  std::vector<int> ends;
+
+  for(int i=0; i<path.size(); i++){
+    int link_end = std::distance(path.begin(), std::find(path.begin() + i + 1, path.end(), -path[i]));
+
+    if(link_end < path.size()){
+      ends.push_back(link_end);
+    }
+  }
+
+  return ends;
+}
+
 bool is_null_vector(const std::vector<int> &v){
   return std::all_of(v.begin(), v.end(), [](const int &x){return x == 0;});
 }
@@ -44,115 +63,524 @@ void fill_used_external(std::vector<char> &used, const PMPath &p, std::vector<in
 
 /// The initialisation function to populate the vector "paths" with all possible space-time paths. It calls either the function
 /// branchPathsCorrect or branchPathsAll, which themselves are recursive functions that will be described in detail below.
+/// If a TaskPool is given, the upper levels of the temporal recursion are split into tasks on that pool.
 
-void PMConfig::populatePaths(){
+void PMConfig::populatePaths(Utility::TaskPool *pool){
+
+  fill_temporal(pool);
+  fill_delta();
+}
 
-  paths.emplace_back(cfgArray.size(), *this);
+/// Populates the paths of a single trace configuration from the temporal links of another configuration in the same
+/// symmetry orbit (under p <-> m, reversal and rotation), instead of running the temporal recursion. Position i of
+/// this configuration corresponds to position position_map[i] of the image. As the rules for a valid link only depend
+/// on the number of p's and m's between the two link points, a valid set of links of the image is a valid set of
+/// links of this configuration and vice versa. The link ids are relabelled in the order of their starting points, and
+/// the paths are sorted in the order temporal_connections would have created them, so the result is identical.
+/// Debug builds verify this against the recursion for the lower orders.
 
-  std::vector<char> used(cfgArray.size());
-  for(int i=0; i<cfgArray.size(); i++){
-    used[i] = false;
+void PMConfig::populatePaths(const std::list< std::vector<int> > &image_links, const std::vector<int> &position_map){
+
+  map_temporal(image_links, position_map);
+  fill_delta();
+}
+
+void PMConfig::map_temporal(const std::list< std::vector<int> > &image_links, const std::vector<int> &position_map){
+
+  if(!is_single()){
+    throw PMConfigError("In function PMConfig::map_temporal():\n"
+        "Only single trace configurations can be populated from the links of another configuration.");
   }
 
-  temporal_connections(0, cfgArray.size(), used, 1);
+  std::vector< std::pair<std::vector<int>, std::vector<int> > > mapped_links;
+
+  for(const std::vector<int> &links : image_links){
+
+    std::vector<int> path(cfgArray.size());
+    std::map<int,int> relabel;
+
+    for(int i=0; i<path.size(); i++){
+      int image_id = abs(links[position_map[i]]);
+      int link_id = relabel.emplace(image_id, relabel.size() + 1).first->second;
+
+      path[i] = cfgArray[i] == Cfg_P ? link_id : -link_id;
+    }
+
+    mapped_links.emplace_back(link_ends(path), std::move(path));
+  }
+
+  std::sort(mapped_links.begin(), mapped_links.end());
+
+  for(const auto &links : mapped_links){
+    paths.emplace_back(links.second.data(), links.second.size(), *this);
+  }
+
+#ifdef _DEBUG
+  //Compare with the full temporal recursion for the lower orders
+  if(cfgArray.size() <= 10){
+    std::list<PMPath> mapped_paths(std::move(paths));
+    paths.clear();
+
+    fill_temporal();
+
+    if( (paths.size() != mapped_paths.size()) or !std::equal(paths.begin(), paths.end(), mapped_paths.begin(),
+          [](const PMPath &lhs, const PMPath &rhs){return lhs.path == rhs.path;}) ){
+      throw PMConfigError("In function PMConfig::map_temporal():\n"
+          "The links mapped from the symmetry partner differ from the ones found by the temporal recursion.");
+    }
+  }
+#endif // _DEBUG
+}
+
+/// Copies the temporal links of all the paths, so that the paths of the symmetry partners can be populated from them
+/// after the paths of this configuration have been released.
+
+void PMConfig::temporalLinks(std::list< std::vector<int> > &links) const{
+
+  for(const PMPath &p : paths){
+    links.emplace_back(p.path.begin(), p.path.end());
+  }
+}
+
+TemporalMemo PMConfig::temporal_memo;
+
+/// Fills the list of paths with all valid temporal links by running the temporal recursion. For multi trace
+/// configurations the recursion only keeps the links which connect all traces with consistent displacements.
+
+void PMConfig::fill_temporal(Utility::TaskPool *pool){
+
+  check_temporal_length();
+
+  LinkArray links;
+  links.fill(0);
+
+  TraceForest forest(cfgArray, trace_points);
 
+  if(pool == nullptr){
+    temporal_connections(0, 0, links, 1, forest, [this](const LinkArray &l){
+      paths.emplace_back(l.data(), cfgArray.size(), *this);
+    });
+  }else{
+    temporal_connections_split(0, 0, links, 1, forest, paths, *pool, parallel_split_depth);
+  }
+
+#ifdef _DEBUG
   if(!is_single()){
-    auto it = paths.begin();
+    for(PMPath &p : paths){
+      if(!p.valid_multi_tr_path(cfgArray,trace_points)){
+        throw PMConfigError("In function PMConfig::fill_temporal():\n"
+            "The temporal recursion let through a multi trace path with inconsistent trace displacements.");
+      }
+    }
+  }
+#endif // _DEBUG
+}
+
+/// Runs the temporal recursion, the spatial paths and the counting part of the gauge integral one temporal path at a
+/// time, keeping only the number of paths, spatial paths and WilsonStrings. Every path is thrown away as soon as it
+/// is counted, so the memory stays that of a single path, and nothing is added to the list of paths.
+
+PathCount PMConfig::countPaths(){
+
+  check_temporal_length();
+
+  LinkArray links;
+  links.fill(0);
+
+  TraceForest forest(cfgArray, trace_points);
+  PathCount count;
+
+  temporal_connections(0, 0, links, 1, forest, [this, &count](const LinkArray &l){
+    PMPath p(l.data(), cfgArray.size(), *this);
+    complete_path(p);
+
+    ++count.paths;
+    count.spatial_paths += p.spatial.size();
+    count.wilson_strings += p.countWilsonStrings(trace_points);
+  });
+
+  return count;
+}
+
+/// The temporal recursion keeps the used link points in a 64 bit mask, so the configurations cannot be longer than
+/// max_temporal_length.
+
+void PMConfig::check_temporal_length() const{
+
+  if(cfgArray.size() > max_temporal_length){
+    char errorMsg[256];
+    sprintf(errorMsg,"In function PMConfig::check_temporal_length():\n"
+        "The temporal recursion supports configurations of length up to %d, not %d",
+        max_temporal_length,(int)cfgArray.size());
+    throw PMConfigError(errorMsg);
+  }
+}
+
+/// Sets up the tables of which trace every link point is in and its height, and a forest where every trace is its
+/// own group. The height of a point is the temporal position, counted from the start of its trace, which has to
+/// match that of its link partner. It is the sum over the ps (+1) and ms (-1) before it, including the point itself
+/// if it is an m. This is the same quantity as calc_trace_displacements uses when it is called on the configuration.
+
+PMConfig::TraceForest::TraceForest(const std::vector<Config> &cfgArray, const std::vector<int> &trace_points)
+  : number_of_traces(trace_points.size())
+{
+  int from = 0;
 
+  for(int t = 0; t < number_of_traces; t++){
 
-    while(it != paths.end()){
-      //if(!valid_multi_tr_path(*it)){
-      std::vector<int> displacements(trace_points.size(),0);
-      if(!it->valid_multi_tr_path(cfgArray,trace_points)){
-        it = paths.erase(it);
-        continue;
+    int height = 0;
+
+    for(int i = from; i < trace_points[t]; i++){
+      point_trace[i] = t;
+
+      if(cfgArray[i] == Cfg_M){
+        height += Cfg_M;
+        point_height[i] = height;
+      }else{
+        point_height[i] = height;
+        height += Cfg_P;
       }
-      it++;
     }
+
+    root[t] = t;
+    size[t] = 1;
+    open[t] = trace_points[t] - from;
+    offset[t] = 0;
+
+    from = trace_points[t];
   }
+}
 
-  fill_delta();
+/// Adds the link between the points from and to (from < to), and returns false if the traces can no longer be
+/// connected consistently: either the link fixes the displacement between two traces of the same group to a
+/// different value than the earlier links, or it uses the last open point of a group which does not contain all
+/// traces, which is then disconnected from the rest for good. The groups are kept flat, every trace points directly
+/// to its root, so there are never more than a few traces to relabel when two groups are merged.
+
+bool PMConfig::TraceForest::link(int from, int to){
+
+  int from_trace = point_trace[from];
+  int to_trace = point_trace[to];
+
+  --open[root[from_trace]];
+  --open[root[to_trace]];
+
+  if(from_trace != to_trace){
+
+    //The displacement of the later trace with respect to the first one required by this link
+    int disp = point_height[from] - point_height[to];
+
+    int from_root = root[from_trace];
+    int to_root = root[to_trace];
+
+    if(from_root == to_root){
+      if(offset[to_trace] - offset[from_trace] != disp){
+        return false;
+      }
+    }else{
+
+      //Move the smaller group under the root of the larger one
+      int move_root, target_root, shift;
+
+      if(size[from_root] < size[to_root]){
+        move_root = from_root;
+        target_root = to_root;
+        shift = offset[to_trace] - disp - offset[from_trace];
+      }else{
+        move_root = to_root;
+        target_root = from_root;
+        shift = offset[from_trace] + disp - offset[to_trace];
+      }
+
+      for(int t = 0; t < number_of_traces; t++){
+        if(root[t] == move_root){
+          root[t] = target_root;
+          offset[t] += shift;
+        }
+      }
+
+      size[target_root] += size[move_root];
+      open[target_root] += open[move_root];
+    }
+  }
+
+  int group = root[from_trace];
+
+  return (open[group] > 0) or (size[group] == number_of_traces);
 }
 
 /// Function which connects a P with an M to form a "link", meaning that they shall happen at the same space-time coordinate.
 /// At the moment, this function also disallows spatial loops, as they do not contribute when the gauge integral is done.
-//
-/// Note on multi trace configurations:
+///
+/// The recursion is done as an iterative depth first search. Every level of the search is the first open link point
+/// (start), which is connected to every valid partner in turn, and its state is kept in a small frame on a stack. The
+/// used link points are a bitmask and the link ids are kept in a fixed array, which is only handed to emit once all
+/// link points are connected. A start point without any valid partner is a dead end, which for multi-trace
+/// configurations can happen, and is simply backtracked from. The paths come out in the same order as for the
+/// straightforward recursion: ordered by the partner of the first link, then the second, and so on.
+///
+/// For multi-trace configurations every level also keeps a TraceForest of the traces connected so far, and a partner
+/// which would leave the traces inconsistently displaced or disconnected is skipped, as calc_trace_displacements
+/// would throw the finished path away anyway. Every complete path therefore connects all the traces.
+///
+/// The search starts from the state given by from, used, links, link_id and forest, which lets
+/// temporal_connections_split hand over partially linked paths. The links array is back to its initial state once
+/// the function returns.
+
+void PMConfig::temporal_connections(int from, std::uint64_t used, LinkArray &links, int link_id,
+    const TraceForest &forest, const LinkSink &emit){
+
+  struct Frame
+  {
+    int start, upper;
+    int next, partner;
+    int count_p, count_m;
+  };
+
+  const int len = cfgArray.size();
+
+  std::array<Frame, max_temporal_length/2 + 1> stack;
+  int depth = 0;
+
+  //The forest before the link of every level, and after the link of the deepest one
+  const bool single = is_single();
+  std::array<TraceForest, max_temporal_length/2 + 2> forests;
+  forests[0] = forest;
+
+  //Opens a new level at the first unused link point from the given position, returns false if there is none
+  auto open_level = [&](int first, int id) -> bool {
+
+    int start = first;
+    while(start != len and (used >> start) & 1){
+      start++;
+    }
+
+    if(start == len){
+      return false;
+    }
+
+    //The upper limit for the current trace
+    stack[depth] = {start, upper_trace_bound(start), start + 1, -1, 0, 0};
+    ++depth;
+
+    used |= std::uint64_t(1) << start;
+    links[start] = cfgArray[start] == Cfg_P ? id : -id;
+
+    return true;
+  };
+
+  if(!open_level(from, link_id)){
+    emit(links);
+    return;
+  }
+
+  while(depth > 0){
+
+    Frame &f = stack[depth-1];
+
+    //Undo the link made the last time this level was visited
+    if(f.partner >= 0){
+      used &= ~(std::uint64_t(1) << f.partner);
+      links[f.partner] = 0;
+      f.partner = -1;
+    }
+
+    Config init_cfg = cfgArray[f.start];
+
+    while(f.next < len and f.partner < 0){
+
+      int i = f.next++;
+
+      // This if-statement checks if the link is valid with the following rules:
+      //   - A P must link to an M, and visa versa
+      //   - The link point cannot be in use by another link
+      //   - either:
+      //    * There must be an equal number of p's and m's between the link, so backtracking is possible
+      //    * One must link outside of the current trace, making e.g. insertions possible
+      //   - The traces must still be able to connect with consistent displacements (multi-trace only)
+      if( (cfgArray[i] != init_cfg) and !((used >> i) & 1) and ( (f.count_p == f.count_m) or i >= f.upper ) ){
+        if(!single){
+          forests[depth] = forests[depth-1];
+        }
+
+        if(single or forests[depth].link(f.start, i)){
+          f.partner = i;
+        }
+      }
+
+      cfgArray[i] == Cfg_P ? ++f.count_p : ++f.count_m;
+    }
+
+    //All partners of this level are done, backtrack
+    if(f.partner < 0){
+      used &= ~(std::uint64_t(1) << f.start);
+      links[f.start] = 0;
+      --depth;
+      continue;
+    }
+
+    used |= std::uint64_t(1) << f.partner;
+    links[f.partner] = -links[f.start];
+
+    int next = f.start + 1;
+    while(next != len and (used >> next) & 1){
+      next++;
+    }
+
+    //If every link point is connected this is a complete path. If all points before the next open one are linked
+    //and none after it, the rest of the links are those of the substring from there, which come from the memo.
+    //Otherwise go one level deeper
+    if(next == len){
+      emit(links);
+    }else if( ((used >> next) == 0) and (len - next >= memo_min_length) and (len - next <= memo_max_length) ){
+      substring_connections(next, abs(links[f.start]) + 1, links, emit);
+    }else{
+      open_level(next, abs(links[f.start]) + 1);
+    }
+  }
+}
+
+/// Emits every way of linking the points from the given one and onwards, all of which have to be unused while all
+/// points before it are linked among themselves. The links of such a substring do not depend on the rest of the
+/// configuration: the rules of the recursion only look at the points between a link point and its partner and at
+/// the trace bounds, and the traces in front have all been connected to the trace the substring starts in (a group
+/// of traces without open points is cut otherwise), so the TraceForest of the substring on its own gives the same
+/// answers. The links are therefore looked up in the temporal_memo, keyed on the p/m substring and its trace ends,
+/// and enumerated by a recursion on the substring the first time it is seen. They come out in the same order as the
+/// recursion would have found them. The links array is back to its initial state once the function returns.
+
+void PMConfig::substring_connections(int from, int link_id, LinkArray &links, const LinkSink &emit){
+
+  const int len = cfgArray.size();
+
+  std::string key;
+  auto trace_end = std::upper_bound(trace_points.begin(), trace_points.end(), from);
+
+  for(int i = from; i < len; i++){
+    key.push_back(cfgArray[i] == Cfg_P ? 'p' : 'm');
+
+    if(i + 1 == *trace_end){
+      key.push_back('.');
+      ++trace_end;
+    }
+  }
+
+  std::shared_ptr<const TemporalMemo::Entry> entry = temporal_memo.find(key);
+
+  if(!entry){
+    PMConfig substring(&cfgArray[from], len - from);
 
-void PMConfig::temporal_connections(int from, int to, std::vector<char> &used, int link_id){ 
+    for(int to : trace_points){
+      if(to > from){
+        substring.trace_points.push_back(to - from);
+      }
+    }
+
+    TemporalMemo::Entry new_entry;
+    new_entry.length = len - from;
+
+    LinkArray substring_links;
+    substring_links.fill(0);
+
+    substring.temporal_connections(0, 0, substring_links, 1, TraceForest(substring.cfgArray, substring.trace_points),
+        [&new_entry](const LinkArray &l){
+          new_entry.links.insert(new_entry.links.end(), l.begin(), l.begin() + new_entry.length);
+        });
+
+    entry = temporal_memo.insert(key, std::move(new_entry));
+  }
+
+  for(std::size_t k = 0; k < entry->size(); k++){
+
+    const std::int8_t * substring_links = (*entry)[k];
+
+    for(int i = 0; i < entry->length; i++){
+      int id = substring_links[i];
+      links[from + i] = (id > 0) ? id + link_id - 1 : id - link_id + 1;
+    }
+
+    emit(links);
+  }
+
+  std::fill(links.begin() + from, links.begin() + len, 0);
+}
+
+/// The same recursion as temporal_connections, but every valid choice of link partner for the first open link point
+/// becomes a task on the pool, with its own copy of the link state. The tasks recurse further (splitting again until
+/// depth reaches zero) into their own path lists, which are spliced back in the order of the link partners once all
+/// of them are done. The resulting list of paths is therefore the same as for the serial recursion. Idle threads
+/// pick up the oldest tasks in the pool, which are the largest subtrees.
+
+void PMConfig::temporal_connections_split(int from, std::uint64_t used, LinkArray &links, int link_id,
+    const TraceForest &forest, std::list<PMPath> &out, Utility::TaskPool &pool, int depth){
+
+  if(depth <= 0){
+    temporal_connections(from, used, links, link_id, forest, [this, &out](const LinkArray &l){
+      out.emplace_back(l.data(), cfgArray.size(), *this);
+    });
+    return;
+  }
+
+  const int len = cfgArray.size();
 
-  //First look for the first unused linking point
   int start = from;
-  while(used[start] and start!=to){
+  while(start != len and (used >> start) & 1){
     start++;
   }
 
-  //If there is none, exit
-  if(start == to){
+  if(start == len){
+    out.emplace_back(links.data(), len, *this);
     return;
   }
 
-  //The upper limit for the current trace
   int upper = upper_trace_bound(start);
 
-  //Push back the start-position, and make a copy of the state
-  paths.back()[start] = cfgArray[start] == Cfg_P ? link_id : -link_id;
-  paths.back().s_paths.front()[start] = paths.back()[start];
-  PMPath init_path(paths.back());
-
   Config init_cfg = cfgArray[start];
   int count_p(0), count_m(0);
 
-  //The start-array is passed around in every recursive call, so I only set its
-  //value temporarily. It is unset before I return
-  used[start] = true;
+  //Every branch gets its own list of paths
+  std::list< std::list<PMPath> > branch_paths;
 
-  bool first_used = false;
+  {
+    Utility::TaskPool::Group group(pool);
 
-  for(int i=(start+1); i<to; i++){
+    for(int i=(start+1); i<len; i++){
 
-    // This if-statement checks if the link is valid with the following rules:
-    //   - A P must link to an M, and visa versa
-    //   - The link point cannot be in use by another link
-    //   - either:
-    //    * There must be an equal number of p's and m's between the link, so backtracking is possible
-    //    * One must link outside of the current trace, making e.g. insertions possible
-    if( (cfgArray[i]!=init_cfg) and !used[i] and ( (count_p == count_m) or i >= upper ) ){
+      TraceForest branch_forest(forest);
 
-      //If the last path has already been filled, append a copy of
-      //the initial path at the end
-      if(first_used){
-        paths.emplace_back(init_path);
-      }
-      paths.back()[i] = -paths.back()[start];
-      paths.back().s_paths.front()[i] = paths.back()[i];
+      if( (cfgArray[i]!=init_cfg) and !((used >> i) & 1) and ( (count_p == count_m) or i >= upper ) and
+          (is_single() or branch_forest.link(start, i)) ){
 
-      //Then set the current link-statue to used and recurse
-      used[i] = true;
-      temporal_connections(start+1, to, used, link_id+1);
-      used[i] = false;
+        branch_paths.emplace_back();
+        std::list<PMPath> *branch_out = &branch_paths.back();
 
-      first_used = true;
+        LinkArray branch_links(links);
+        branch_links[start] = cfgArray[start] == Cfg_P ? link_id : -link_id;
+        branch_links[i] = -branch_links[start];
+
+        std::uint64_t branch_used = used | (std::uint64_t(1) << start) | (std::uint64_t(1) << i);
+
+        group.run([this, start, link_id, branch_out, branch_used, branch_links, branch_forest, &pool, depth]() mutable {
+          temporal_connections_split(start+1, branch_used, branch_links, link_id+1, branch_forest, *branch_out,
+              pool, depth-1);
+        });
+      }
+
+      cfgArray[i] == Cfg_P ? ++count_p : ++count_m;
     }
 
-    cfgArray[i] == Cfg_P ? ++count_p : ++count_m;
+    group.wait();
   }
 
-  // As the multi-trace configurations can start building invalid path configurations, we have to remove it if no link 
-  // could be made
-  if(!first_used){
-    paths.pop_back();
+  for(std::list<PMPath> &branch : branch_paths){
+    out.splice(out.end(), branch);
   }
-
-  used[start] = false;
 }
 
-/// Iterates over all the paths and calls the single-path crossing function assuming no trace-points
+/// Calls the single-path crossing function on a path, assuming no trace-points
 
-void PMConfig::complete_single_trace(){
-  for(auto &p : paths){
-    single_path_crossing(0,cfgArray.size(),p);
-  }
+void PMConfig::complete_single_trace(PMPath &p){
+  single_path_crossing(0,cfgArray.size(),p);
 }
 
 /// The function corresponding to complete_single_trace, but for multi-traces. There are multiple things which has
@@ -163,50 +591,40 @@ void PMConfig::complete_single_trace(){
 ///      single trace elements, but the disconnected traces can themselves be spatially displaced, making it
 ///      more complicated.
 
-void PMConfig::complete_multi_trace(){
-
-  std::vector<char> used(cfgArray.size());
-
-  for(PMPath &p : paths){
-
-    int from = 0;
-    for(auto to : trace_points){
-      positional_delta(from, to, p); //takes care of point 1
-      single_path_crossing(from, to, p); //takes partially care of point 2
-      from = to;
-    }
-
+void PMConfig::complete_multi_trace(PMPath &p){
 
-    p.fill_trace_displacements(trace_points); //fixes the final issues of point 2
+  int from = 0;
+  for(auto to : trace_points){
+    positional_delta(from, to, p); //takes care of point 1
+    single_path_crossing(from, to, p); //takes partially care of point 2
+    from = to;
+  }
 
-    if(p.s_paths.size() < 2){
-      continue;
-    }
 
+  std::vector<int> dof = p.fill_trace_displacements(trace_points); //fixes the final issues of point 2
 
-    //Remove all paths which have a lesser amount of free indecies than the others.
-    //They are most likely duplicates of some sort.
+  if(p.s_paths.size() < 2){
+    return;
+  }
 
-    std::vector<int> dof(p.s_paths.size());
 
-    int i=0;
-    for(std::vector<int> &s_p : p.s_paths){
-      dof[i] = degrees_of_freedom(s_p.begin(), s_p.end());
-      i++;
-    }
+  //Remove all paths which have a lesser amount of free indecies than the others.
+  //They are most likely duplicates of some sort.
 
-    int highest_dof = *(std::max_element(dof.begin(), dof.end()));
+  int highest_dof = *(std::max_element(dof.begin(), dof.end()));
 
-    i = 0;
-    auto it = p.s_paths.begin();
-    while(it != p.s_paths.end()){
-      if(dof[i] < highest_dof){
-        it = p.s_paths.erase(it);
-      }else{
-        ++it;
-      }
-      i++;
+  int i = 0;
+  auto it = p.s_paths.begin();
+  auto disp_it = p.trace_disp.begin();
+  while(it != p.s_paths.end()){
+    if(dof[i] < highest_dof){
+      it = p.s_paths.erase(it);
+      disp_it = p.trace_disp.erase(disp_it);
+    }else{
+      ++it;
+      ++disp_it;
     }
+    i++;
   }
 }
 
@@ -222,13 +640,12 @@ void PMConfig::single_path_crossing(int from, int to, PMPath &path){
 
   for(int i=from; i<to; i++){
 
-    int lnk_val = path[i];
-    auto lnk_it = std::find_if(path.path.begin()+i+1, path.path.begin()+to, [lnk_val](const int &x){return x == -lnk_val;});
+    int lnk = path.linkPartner(i);
 
-    if(lnk_it == (path.path.begin()+to)) continue;
+    if( (lnk <= i) or (lnk >= to) ) continue;
 
     int lnk_from = i + 1;
-    int lnk_to   = std::distance(path.path.begin(), lnk_it);
+    int lnk_to   = lnk;
 
     positional_delta(lnk_from, lnk_to, path); //Spatial kronecker delta between from and to
   }
@@ -251,15 +668,15 @@ void PMConfig::positional_delta(int from, int to, PMPath &path){
       pos += sp[i];
     }
 
-    //Temporary list to pass to the delta-function, which contains one copy of
-    //the current spatial path.
-    std::list< std::vector<int> > send_paths(1,sp);
-    spatial_contractions(pos,send_paths);
+    SpatialContractions contractions(pos,sp);
+    std::vector<int> s_path;
 
-    new_s_paths.splice(new_s_paths.end(), std::move(send_paths));
+    while(contractions.next(s_path)){
+      new_s_paths.push_back(std::move(s_path));
+    }
   }
 
-  remove_duplicates(new_s_paths);
+  remove_relabelled_duplicates(new_s_paths);
   path.s_paths = std::move(new_s_paths);
 }
 
@@ -1,9 +1,10 @@
 //Created: 09-09-2013
-//Modified: Tue 19 Aug 2014 11:32:57 CEST
+//Modified: Sun 18 Oct 2026 00:12:45 CEST
 //Author: Jonas R. Glesaaen (jonas@glesaaen.com)
 //Description: Implementation of the member functions of the class PMPath
 
 #include"pm.paths.h"
+#include"pm.config.h"
 
 namespace hop{
 
@@ -47,34 +48,64 @@ bool more_than_N_occurances(InputIt first, InputIt last, int N){
 PMPath& PMPath::operator=(const PMPath &rhs){
 
 	path = rhs.path;
+	partner = rhs.partner;
+	trace_id = rhs.trace_id;
+	spatial = rhs.spatial;
 	deltas = rhs.deltas;
 	w = rhs.w;
 
 	return *this;
 }
 
-/// Function finds the link-point corresponding to the index a. It returns a negative index if the link is behind, and a positive index if it is ahead
-/// other than that I'd say the function is rather self-explanatory
+/// Fills the link partner and trace tables from the temporal links of the path and the trace points of the parent,
+/// so that the link and trace of a point are a single lookup in the later stages.
 
-int PMPath::findLink(int a) const {
+void PMPath::fill_link_tables(){
+
+	partner.assign(path.size(), -1);
+	trace_id.assign(path.size(), 0);
 
-	int mlnk = -path.at(a);
+	//The first point seen with every link id, the ids go from 1 to half the path length
+	std::vector<int> first_point(path.size()/2 + 1, -1);
 
-	for(int i=0; i<a; i++){
-		if(path[i] == mlnk){
-			return -i;
+	for(int i=0; i<path.size(); i++){
+
+		int id = abs(path[i]);
+
+		if(id == 0 or id >= first_point.size()){
+			continue;
 		}
-	}
 
-	for(int i=(a+1); i<path.size(); i++){
-		if(path[i] == mlnk){
-			return i;
+		if(first_point[id] < 0){
+			first_point[id] = i;
+		}else{
+			partner[i] = first_point[id];
+			partner[first_point[id]] = i;
 		}
 	}
 
-	throw PMPathError("Unable to find matching link in function PMPath::findLink(int)");
+	int from = 0;
+	for(int tr_ind=0; tr_ind<parent.numberOfTraces(); tr_ind++){
+
+		int to = std::min<int>(parent.tracePoints()[tr_ind], path.size());
 
-	return 0;
+		std::fill(trace_id.begin() + from, trace_id.begin() + to, tr_ind);
+		from = to;
+	}
+}
+
+/// Function finds the link-point corresponding to the index a. It returns a negative index if the link is behind, and a positive index if it is ahead
+/// other than that I'd say the function is rather self-explanatory
+
+int PMPath::findLink(int a) const {
+
+	int lnk = partner.at(a);
+
+	if(lnk < 0){
+		throw PMPathError("Unable to find matching link in function PMPath::findLink(int)");
+	}
+
+	return (lnk < a) ? -lnk : lnk;
 }
 
 void PMPath::remove_special_spatial_paths(const std::vector<int> &trace_points){
@@ -108,6 +139,17 @@ void PMPath::remove_special_spatial_paths(const std::vector<int> &trace_points){
 	}
 }
 
+/// Once the spatial paths are complete they are only read, so they are packed into the arena together with their
+/// trace displacements, and the lists used while building them are released.
+
+void PMPath::compact(){
+
+	spatial.assign(s_paths, trace_disp, path.size()/2);
+
+	s_paths.clear();
+	trace_disp.clear();
+}
+
 /// Function which finds out the position of the first element of the Wilson-list, and translates all other elements 
 /// so that this element is located at x. This function is meant to be run after the Wilson list has been sorted using
 /// list::sort()
@@ -1,5 +1,5 @@
 //Created: 27-09-2013
-//Modified: Wed 26 Apr 2017 17:49:53 BST
+//Modified: Sun 18 Oct 2026 00:26:08 CEST
 //Author: Jonas R. Glesaaen (jonas@glesaaen.com)
 //Description: Implementation of the functions related to the gauge-integral of the PMPath-class.
 // 	       Also implementation of the Wilson-struct member functions
@@ -29,6 +29,197 @@ void trace_rotate_indecies(std::vector<int> &indecies, const std::vector<int> &t
 	}
 }
 
+/// The times which appear in a Wilson line of more than two gauge elements. Only the orderings of these affect the
+/// terms, see PMPath::gaugeIntegrate.
+
+std::set<int> permuted_times(const std::vector< std::vector<int> > &times){
+
+	std::set<int> time_permutations;
+
+	for(const std::vector<int> &t : times){
+		if(t.size() > 2)
+			time_permutations.insert(t.begin(), t.end());
+	}
+
+	return time_permutations;
+}
+
+#ifdef _DEBUG
+
+/// Goes through all orderings of the permuted times, and counts how often every combination of the second Wilson
+/// line indices (the numerators) comes up. Only used by debug builds to check count_numerators for a small number of
+/// permuted times.
+
+void count_numerators_enumerated(const std::vector< std::vector<int> > &times, const std::set<int> &time_permutations,
+		Utility::CountedSet< std::vector<int> > &numerators){
+
+  std::vector<int> time_order(time_permutations.begin(), time_permutations.end());
+  size_t number_of_factors = times.size();
+
+  for(Utility::Permutation::Lexicographic< std::vector<int> > perm(time_order.begin(), time_order.end());
+      !perm; ++perm) {
+
+    std::vector<int> these_numerators(number_of_factors,0);
+
+		for(int i=0; i < number_of_factors; i++){
+
+      size_t number_of_branches = times[i].size();
+
+			if(number_of_branches < 3){
+        these_numerators[i] = 1;
+				continue;
+			}
+
+			std::vector<int> time_indexed(number_of_branches);
+
+      for(int j = 0; j < number_of_branches; ++j) {
+        auto it = std::find(time_order.begin(), time_order.end(), times[i][j]);
+
+        if(it == time_order.end())
+          throw std::runtime_error("Could not find the time index");
+
+        time_indexed[j] = std::distance(time_order.begin(), it);
+      }
+
+      for(int j = 0; j < (number_of_branches - 1); ++j)
+        if(time_indexed[j+1] < time_indexed[j])
+          ++these_numerators[i];
+
+      if(time_indexed.front() < time_indexed.back())
+        ++these_numerators[i];
+		}
+
+    numerators.insert(these_numerators);
+	}
+}
+
+#endif //_DEBUG
+
+/// Counts how often every combination of the second Wilson line indices (the numerators) comes up over all orderings
+/// of the permuted times. The numerator of a Wilson line with more than two times is its number of cyclic descents,
+/// the number of neighbouring times (including the last and the first) where the second comes before the first.
+///
+/// Instead of going through all k! orderings, the orderings are built by placing the times one at a time, each after
+/// all the ones placed before it. Placing time t completes a descent for every neighbouring pair (t, u) where u has
+/// already been placed, so the descents added only depend on the set of times placed so far. The distribution of the
+/// partial numerators is therefore kept for every such set, and the full set holds the distribution over all
+/// orderings, in 2^k k steps.
+
+void count_numerators(const std::vector< std::vector<int> > &times, const std::set<int> &time_permutations,
+		Utility::CountedSet< std::vector<int> > &numerators){
+
+	std::vector<int> time_order(time_permutations.begin(), time_permutations.end());
+	int number_of_times = time_order.size();
+	std::size_t number_of_factors = times.size();
+
+	if(number_of_times >= 8*sizeof(unsigned int)){
+		throw std::runtime_error("Too many permuted times to count the numerators");
+	}
+
+	auto time_index = [&time_order](int t){
+		auto it = std::lower_bound(time_order.begin(), time_order.end(), t);
+
+		if(it == time_order.end() or *it != t)
+			throw std::runtime_error("Could not find the time index");
+
+		return static_cast<int>(std::distance(time_order.begin(), it));
+	};
+
+	//For every time, the neighbouring pairs it is the first of, as the factor and the index of the second time
+	std::vector< std::vector< std::pair<int,int> > > descents_from(number_of_times);
+
+	std::vector<int> init_numerators(number_of_factors,0);
+
+	for(int i=0; i<number_of_factors; i++){
+
+		std::size_t number_of_branches = times[i].size();
+
+		if(number_of_branches < 3){
+			init_numerators[i] = 1;
+			continue;
+		}
+
+		for(int j=0; j<number_of_branches; j++){
+			int from = time_index(times[i][j]);
+			int to = time_index(times[i][(j+1)%number_of_branches]);
+
+			if(from != to)
+				descents_from[from].emplace_back(i,to);
+		}
+	}
+
+	//The distribution of the partial numerators for every set of placed times, indexed by the set as a bit mask
+	unsigned int full_set = (1u << number_of_times) - 1;
+	std::vector< std::map<std::vector<int>,int> > partial(full_set + 1);
+
+	partial[0][init_numerators] = 1;
+
+	for(unsigned int placed = 0; placed < full_set; ++placed){
+
+		for(const auto &state : partial[placed]){
+			for(int t=0; t<number_of_times; t++){
+
+				if(placed & (1u << t))
+					continue;
+
+				std::vector<int> next_numerators(state.first);
+
+				for(const auto &pair : descents_from[t]){
+					if(placed & (1u << pair.second))
+						++next_numerators[pair.first];
+				}
+
+				partial[placed | (1u << t)][next_numerators] += state.second;
+			}
+		}
+
+		partial[placed].clear();
+	}
+
+	for(const auto &state : partial[full_set])
+		numerators.insert(Utility::Counted< std::vector<int> >(state.first, state.second));
+
+	#ifdef _DEBUG //Check against going through all the orderings, while there are few enough of them
+	if(number_of_times <= 7){
+		Utility::CountedSet< std::vector<int> > enumerated;
+		count_numerators_enumerated(times, time_permutations, enumerated);
+
+		bool same = (enumerated.size() == numerators.size()) and
+		            std::equal(enumerated.begin(), enumerated.end(), numerators.begin(),
+		                       [](const Utility::Counted< std::vector<int> > &lhs,
+		                          const Utility::Counted< std::vector<int> > &rhs){
+		                         return (lhs.obj() == rhs.obj()) and (lhs.count() == rhs.count());
+		                       });
+
+		if(!same)
+			throw PMPathError("In function count_numerators:\n"
+					  "The counted numerators differ from the ones found by going through all orderings.");
+	}
+	#endif //_DEBUG
+}
+
+/// For every color index, the gauge element whose left index it is. Every index is the left index of exactly one
+/// element after the contractions, so following a Wilson line from element to element is a lookup in this table.
+
+std::vector<int> index_owners(const std::vector<int> &indecies){
+
+	std::vector<int> owners(indecies.size()+1, -1);
+
+	for(int j=0; 2*j<indecies.size(); j++){
+
+		#ifdef _DEBUG
+		if(owners[indecies[2*j]] != -1){
+			throw PMPathError("In function index_owners(indecies):\n"
+					  "Two gauge elements share the same left index.");
+		}
+		#endif //_DEBUG
+
+		owners[indecies[2*j]] = j;
+	}
+
+	return owners;
+}
+
 template <class Type>
 std::ostream& operator<<(std::ostream &os, const std::vector<Type> &v){
 
@@ -59,29 +250,15 @@ std::ostream& operator<<(std::ostream &os, const std::vector<Type> &v){
 
 void PMPath::gaugeIntegrate(const std::vector<int> &trace_points){
 
-	//These are the color matrix indecies. These will be manipulated further down and be
-	//converted to matrix multiplications and traces. They start at 1. These are the 
-	//indecies of the U-matrices, and thus the ones which will be contracted when
-	//we do the gauge-integral.
-	std::vector<int> indecies(2*path.size());
-	for(int i=0; i<indecies.size(); i++){
-		indecies[i] = (i+1);
-	}
-
-	//Now go through the index array and contract indecies according to the integral given in
-	//the description of this function
-	for(int i=0; i<path.size(); i++){
-		int lnk = findLink(i);
-		if(lnk < 0) continue;
-
-		indecies[2*lnk+1] = indecies[2*i];
-		indecies[2*lnk] = indecies[2*i+1];
-	}
+	if(spatial.empty())
+		return;
 
-	//Cyclicly rotate the index matrix according to the trace. Basically move the last index of every trace to the front of the same trace
-	trace_rotate_indecies(indecies, trace_points);
+	//These are the color matrix indecies. They are contracted according to the integral given in the description
+	//of this function, and the Wilson lines are found by following them from gauge element to gauge element.
+	std::vector<int> indecies = contracted_indecies(trace_points);
+	std::vector< std::vector<int> > times = wilson_times(indecies);
 
-	std::vector< std::vector<int> > times = set_wilson_positions(trace_points,indecies);
+	set_wilson_positions(trace_points,indecies);
 
 	#ifdef _DEBUG
 
@@ -107,12 +284,7 @@ void PMPath::gaugeIntegrate(const std::vector<int> &trace_points){
 	  * we loop through the Permutations struct significantly.
 	  */
 
-	std::set<int> time_permutations;
-
-	for(const std::vector<int> &t : times){
-		if(t.size() > 2)
-			time_permutations.insert(t.begin(), t.end());
-	}
+	std::set<int> time_permutations = permuted_times(times);
 
 	if(time_permutations.empty()){
 
@@ -131,45 +303,7 @@ void PMPath::gaugeIntegrate(const std::vector<int> &trace_points){
 	}
 
   Utility::CountedSet< std::vector<int> > numerators;
-
-  std::vector<int> time_order(time_permutations.begin(), time_permutations.end());
-  size_t number_of_factors = times.size();
-
-  for(Utility::Permutation::Lexicographic< std::vector<int> > perm(time_order.begin(), time_order.end());
-      !perm; ++perm) {
-
-    std::vector<int> these_numerators(number_of_factors,0);
-
-		for(int i=0; i < number_of_factors; i++){
-
-      size_t number_of_branches = times[i].size();
-
-			if(number_of_branches < 3){
-        these_numerators[i] = 1;
-				continue;
-			}
-
-			std::vector<int> time_indexed(number_of_branches);
-
-      for(int j = 0; j < number_of_branches; ++j) {
-        auto it = std::find(time_order.begin(), time_order.end(), times[i][j]);
-
-        if(it == time_order.end())
-          throw std::runtime_error("Could not find the time index");
-
-        time_indexed[j] = std::distance(time_order.begin(), it);
-      }
-
-      for(int j = 0; j < (number_of_branches - 1); ++j)
-        if(time_indexed[j+1] < time_indexed[j])
-          ++these_numerators[i];
-
-      if(time_indexed.front() < time_indexed.back())
-        ++these_numerators[i];
-		}
-
-    numerators.insert(these_numerators);
-	}
+  count_numerators(times, time_permutations, numerators);
 
 	std::list<WilsonString> spatial_terms(std::move(w));
 	w.clear();
@@ -222,22 +356,85 @@ void PMPath::gaugeIntegrate(const std::vector<int> &trace_points){
 
 }
 
-std::vector< std::vector<int> > 
-PMPath::set_wilson_positions(
+/// The color matrix indecies of the gauge elements after the gauge integral. They start out as 1,2,3,... (two for
+/// every U-matrix) and the indecies of every link are contracted with the formula given above gaugeIntegrate.
+/// Finally every trace is cyclicly rotated, moving the last index of the trace to the front.
+
+std::vector<int> PMPath::contracted_indecies(const std::vector<int> &trace_points) const{
+
+	std::vector<int> indecies(2*path.size());
+	for(int i=0; i<indecies.size(); i++){
+		indecies[i] = (i+1);
+	}
+
+	for(int i=0; i<path.size(); i++){
+		int lnk = findLink(i);
+		if(lnk < 0) continue;
+
+		indecies[2*lnk+1] = indecies[2*i];
+		indecies[2*lnk] = indecies[2*i+1];
+	}
+
+	trace_rotate_indecies(indecies, trace_points);
+
+	return indecies;
+}
+
+/// Follows the contracted indecies from gauge element to gauge element to find the Wilson lines. Every Wilson line
+/// starts at the first gauge element not already in another one, and the returned vector contains the temporal
+/// variables (link ids) which go into every Wilson line. They are the same for every spatial path.
+
+std::vector< std::vector<int> > PMPath::wilson_times(const std::vector<int> &indecies) const{
+
+	std::vector< std::vector<int> > times;
+	std::vector<char> used(path.size(),false);
+	std::vector<int> owners = index_owners(indecies);
+
+	for(int i=0; i<path.size(); i++){
+
+		if(used[i])
+			continue;
+
+		int indexLeft(indecies[2*i]), indexRight(indecies[2*i+1]);
+
+		times.emplace_back();
+		times.back().push_back(abs(path[i]));
+
+		while(indexLeft != indexRight){
+			int j = owners[indexRight];
+
+			indexRight = indecies[2*j+1];
+			used[j] = true;
+
+			times.back().push_back(abs(path[j]));
+		}
+	}
+
+	return times;
+}
+
+/// Creates one WilsonString for every spatial path, with the Wilson lines found in the same way as in wilson_times,
+/// placed at the spatial position of their first gauge element.
+
+void PMPath::set_wilson_positions(
     const std::vector<int> & trace_points, 
     const std::vector<int> & indecies)
 {
   Position::pos zero_pos(path.size()/2);
+	std::vector<int> owners = index_owners(indecies);
 
-	std::list< std::vector<int> >::iterator sp_it = s_paths.begin();
-	std::list< std::vector<Position::pos> >::iterator disp_it = trace_disp.begin();
+	for(std::size_t k = 0; k < spatial.size(); ++k){
 
-	//The times vector contains a list of which temporal variables go into which Wilson term. They will be the same
-	//for every spatial position, so I should only fill it once
-	std::vector< std::vector<int> > times;
-	bool times_set = false;
+		const std::int8_t * s_path = spatial.spatialPath(k);
 
-	while(sp_it != s_paths.end()){
+		//The positions of all gauge elements of this spatial path
+		std::vector<Position::pos> positions;
+
+		if(spatial.hasDisplacements()){
+			positions = position_table(trace_points,s_path,spatial.displacements(k));
+		}else{
+			positions = position_table(path.size(),zero_pos,s_path);
+		}
 
 		//An array which saves which gauge elements have already been included, so that I don't count them multiple times
 		std::vector<char> used(path.size(),false);
@@ -253,58 +450,50 @@ PMPath::set_wilson_positions(
 
 			int indexLeft(indecies[2*i]), indexRight(indecies[2*i+1]);
 
-			if(!times_set){
-				times.emplace_back();
-				times.back().push_back(abs(path[i]));
-			}
-
 			w.back().wilsons.emplace_back();
 			w.back().wilsons.back().n = 1;
 			w.back().wilsons.back().m = 1;
 
-			if(trace_disp.empty()){
-				w.back().wilsons.back().pos = calculate_position(i,zero_pos,*sp_it);
-			}else{
-				w.back().wilsons.back().pos = calculate_position(i,trace_points,*sp_it,*disp_it);
-			}
+			w.back().wilsons.back().pos = positions[i];
 
 			while(indexLeft != indexRight){
-				for(int j=0; j<path.size(); j++){
-					if(!used[j] and (indexRight == indecies[2*j])){
-						indexRight = indecies[2*j+1];
-						used[j] = true;
-
-						if(!times_set){
-							times.back().push_back(abs(path[j]));
-						}
-
-						w.back().wilsons.back().n++;
-
-						#ifdef _DEBUG //Check if the gauge elements are at the same spatial positions
-            Position::pos this_pos;
-
-						if(trace_disp.empty()){
-							this_pos = calculate_position(i,zero_pos,*sp_it);
-						}else{
-							this_pos = calculate_position(i,trace_points,*sp_it,*disp_it);
-						}
-
-						if(this_pos != w.back().wilsons.back().pos){
-							throw PMPathError("In function gaugeIntegral:\n"
-									  "The position of the different elements in a trace are "
-									  "at different positions");
-						}
-						#endif //_DEBUG
-					}
+				int j = owners[indexRight];
+
+				indexRight = indecies[2*j+1];
+				used[j] = true;
+
+				w.back().wilsons.back().n++;
+
+				#ifdef _DEBUG //Check if the gauge elements are at the same spatial positions
+				if(positions[j] != w.back().wilsons.back().pos){
+					throw PMPathError("In function gaugeIntegral:\n"
+							  "The position of the different elements in a trace are "
+							  "at different positions");
 				}
+				#endif //_DEBUG
 			}
 		}
-
-		times_set = true;
-		sp_it++; if(!trace_disp.empty()) disp_it++;
 	}
+}
 
-	return times;
+/// The number of WilsonStrings gaugeIntegrate would create, without creating them: one for every spatial path and
+/// every distinct combination of numerators.
+
+std::size_t PMPath::countWilsonStrings(const std::vector<int> &trace_points) const{
+
+	if(spatial.empty())
+		return 0;
+
+	std::vector< std::vector<int> > times = wilson_times(contracted_indecies(trace_points));
+	std::set<int> time_permutations = permuted_times(times);
+
+	if(time_permutations.empty())
+		return spatial.size();
+
+	Utility::CountedSet< std::vector<int> > numerators;
+	count_numerators(times, time_permutations, numerators);
+
+	return numerators.size()*spatial.size();
 }
 
 }; //Namespace hop
@@ -1,5 +1,5 @@
 //Created: 09-09-2013
-//Modified: Wed 26 Apr 2017 18:07:51 BST
+//Modified: Sun 18 Oct 2026 00:12:45 CEST
 //Author: Jonas R. Glesaaen (jonas@glesaaen.com)
 
 #ifndef PMPATHS_H
@@ -30,6 +30,7 @@
 #include"pm.typedef.h"
 #include"pm.utility.h"
 #include"pm.wilson.h"
+#include"spatial_arena.hpp"
 
 #include"collector.hpp"
 #include"printers.hpp"
@@ -57,10 +58,17 @@ friend class TermCollector;
 friend void rectify_spatial_path(Position::pos &,PMPath &p,std::list< std::vector<int> >::iterator);
 
 private:
-	std::vector<int> path;
+	std::vector<std::int8_t> path;
+
+	//For every point, the point it is linked to (-1 if none), and the index of the trace it is in
+	std::vector<std::int8_t> partner, trace_id;
+
 	std::list< std::vector<int> > s_paths;
 	std::list< std::vector<Position::pos> > trace_disp;
 
+	//The finished spatial paths and trace displacements, see compact()
+	SpatialArena spatial;
+
 	KD_Expr deltas;
 
 	std::list<WilsonString> w;
@@ -70,22 +78,31 @@ private:
 
   const PMConfig & parent;
 
+  void fill_link_tables();
+
 
 public:
   PMPath(int len, const PMConfig &p)
-      : path(len, 0), s_paths(1, std::vector<int>(len, 0)), parent(p){};
+      : path(len, 0), s_paths(1, std::vector<int>(len, 0)), parent(p)
+  {
+    fill_link_tables();
+  }
 
   PMPath(const int *dat, int len, const PMConfig &p)
       : path(dat, dat + len),
         s_paths(1, std::vector<int>(dat, dat + len)),
         parent(p)
   {
+    fill_link_tables();
   }
 
   PMPath(const PMPath &rhs)
       : path(rhs.path),
+        partner(rhs.partner),
+        trace_id(rhs.trace_id),
         s_paths(rhs.s_paths),
         trace_disp(rhs.trace_disp),
+        spatial(rhs.spatial),
         deltas(rhs.deltas),
         w(rhs.w),
         parent(rhs.parent)
@@ -94,11 +111,8 @@ public:
 
   ~PMPath(){};
 
-	int& operator[](int i) {return path[i];}; 
-	const int& operator[](int i) const {return path[i];};
-
-	int& at(int i) {return path.at(i);};
-	const int& at(int i) const {return path.at(i);};
+	int operator[](int i) const {return path[i];};
+	int at(int i) const {return path.at(i);};
 
 	//friend bool operator==(const PMPath&,const PMPath&);
 	PMPath& operator=(const PMPath&);
@@ -108,16 +122,24 @@ public:
 	int size() const {return path.size();};
 
 	int findLink(int) const;
+	int linkPartner(int i) const {return partner[i];};
+	int traceOf(int i) const {return trace_id[i];};
 	void remove_special_spatial_paths(const std::vector<int>&);
 
 	//Functions related to the filling of the kronecker deltas
 	//bool crossing();
 	void appendDeltas(const KD_Term &new_deltas) {deltas *= new_deltas;};
 
+	//Moves the finished spatial paths and trace displacements into the arena
+	void compact();
+
 	//Functions related to the gauge-integral, implemented in pm.paths.gauge.cpp
 	void gaugeIntegrate();
 	void gaugeIntegrate(const std::vector<int>&);
-	std::vector< std::vector<int> > set_wilson_positions(const std::vector<int> &trace_points, const std::vector<int> &indecies);
+	void set_wilson_positions(const std::vector<int> &trace_points, const std::vector<int> &indecies);
+	std::vector<int> contracted_indecies(const std::vector<int> &trace_points) const;
+	std::vector< std::vector<int> > wilson_times(const std::vector<int> &indecies) const;
+	std::size_t countWilsonStrings(const std::vector<int> &trace_points) const;
 	//void translateCoordinates();
 	
 	void collect(Collector & coll)
@@ -129,8 +151,8 @@ public:
   {
     printer.PrintPMPath(*this);
 
-    for(const auto & spatial : s_paths)
-      printer.PrintPathList(spatial);
+    for(std::size_t k = 0; k < spatial.size(); ++k)
+      printer.PrintPathList(spatial.spatialPathVector(k));
 
     for(const WilsonString & wil : w)
       wil.print(printer);
@@ -140,8 +162,7 @@ public:
 
 	//Trace-related functions, mostly trace-displacements, and the calculation of them
 	
-	void fill_trace_displacements(const std::vector<int> &trp);
-	std::list< std::vector<int> >::iterator fix_spatial_path(Position::pos &,std::list< std::vector<int> >::iterator);
+	std::vector<int> fill_trace_displacements(const std::vector<int> &trp);
 	bool valid_multi_tr_path(const std::vector<Config> &cfgArray, const std::vector<int> &trace_points);
 
 	template <class PosType, class PathType>
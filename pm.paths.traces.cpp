@@ -1,64 +1,168 @@
 //Created: 11-03-2014
-//Modified: Mon 18 Aug 2014 11:52:00 CEST
+//Modified: Sun 18 Oct 2026 00:51:37 CEST
 //Author: Jonas R. Glesaaen (jonas@glesaaen.com)
 
 #include"pm.paths.h"
 
+#include<deque>
+#include<unordered_set>
+
 //// Implementation of PMPath member functions related to the multi-trace paths. Specifically trace displacements and spatial
 //// paths
 
 namespace hop{
 
+namespace{
+
+//// The groups of traces which are connected by the links seen so far, as a weighted union-find. Every trace stores
+//// its displacement relative to its parent, and find() compresses the path to the root while adding up the
+//// displacements, so that afterwards displacement(t) is the displacement of t relative to the root of its group.
+//// The smaller group is put below the root of the larger one.
+
+template <class PosType>
+class TraceDisplacementForest
+{
+private:
+	std::vector<int> parent, size;
+	std::vector<PosType> offset;
+
+public:
+	TraceDisplacementForest(int number_of_traces, const PosType &zero)
+		: parent(number_of_traces), size(number_of_traces,1), offset(number_of_traces,zero)
+	{
+		for(int t=0; t<number_of_traces; t++){
+			parent[t] = t;
+		}
+	};
+
+	int find(int t)
+	{
+		int p = parent[t];
+
+		if(p == t){
+			return t;
+		}
+
+		int root = find(p);
+
+		if(p != root){
+			offset[t] += offset[p];
+			parent[t] = root;
+		}
+
+		return root;
+	};
+
+	//Only valid directly after find(t)
+	const PosType& displacement(int t) const {return offset[t];};
+
+	/// Adds a link between trace a and trace b, where rel_pos is the position of the link end in b minus that of the
+	/// link end in a, both relative to the start of their traces. If the traces are already in the same group it
+	/// returns whether the link agrees with their displacements, and otherwise leaves rel_pos holding the mismatch.
+	bool link(int a, int b, PosType &rel_pos)
+	{
+		int root_a = find(a), root_b = find(b);
+
+		if(root_a == root_b){
+			rel_pos += offset[a];
+			rel_pos -= offset[b];
+
+			return pos_is_zero(rel_pos);
+		}
+
+		//The displacement of root_b relative to root_a, which makes the two link ends meet
+		PosType root_disp(offset[a]);
+		root_disp += rel_pos;
+		root_disp -= offset[b];
+
+		if(size[root_a] < size[root_b]){
+			parent[root_a] = root_b;
+			offset[root_a] = -root_disp;
+			size[root_b] += size[root_a];
+		}else{
+			parent[root_b] = root_a;
+			offset[root_b] = std::move(root_disp);
+			size[root_a] += size[root_b];
+		}
+
+		return true;
+	};
+};
+
+}; //Anonymous namespace
+
 /// Fills the list of trace displacements and fixes trace-displacement problems. If the trace passes the initial
 /// valid_multi_tr_path-check, the configuration is valid, but the trace-displacement might not all match. 
 ///
 /// E.g. a trace might be displaced by both "0" and "i-j", which means that if i=j, the config is valid.
+///
+/// The spatial paths are solved from a worklist, and a problematic path is replaced by its contractions, which are
+/// added to the back of the worklist. Every distinct spatial path is only solved once, and a solved path is only kept
+/// if it is not a relabelling of one kept before it. Returns the degrees of freedom of the kept spatial paths, see
+/// CanonicalSpatialPath.
 
-void PMPath::fill_trace_displacements(const std::vector<int> &trace_points){
+std::vector<int> PMPath::fill_trace_displacements(const std::vector<int> &trace_points){
 
   Position::pos zero_pos(size()/2);
 
-	auto it = s_paths.begin();
+	std::deque< std::vector<int> > worklist(std::make_move_iterator(s_paths.begin()), std::make_move_iterator(s_paths.end()));
+	s_paths.clear();
 
-	while(it != s_paths.end()){
+	//The spatial paths which have been solved, and the canonical forms of the ones which have been kept
+	std::unordered_set< std::vector<int>, boost::hash< std::vector<int> > > solved;
+	std::deque<CanonicalSpatialPath> canonical;
+	PointeeSet<CanonicalSpatialPath> kept;
+
+	std::vector<int> dof;
+
+	while(!worklist.empty()){
+
+		std::vector<int> s_path(std::move(worklist.front()));
+		worklist.pop_front();
+
+		if(!solved.insert(s_path).second){
+			continue;
+		}
 
 		//If the calculation fails, the problematic position (which should be zero), is stored in prob_pos
     Position::pos prob_pos(zero_pos);  
 		std::vector<Position::pos> trace_displacements(trace_points.size(),zero_pos);
 
-		//If the calculation fails, we need to impose a delta on prob_pos, which will change the spatial paths,
-		//meaning that we need to re-calculate it. The problematic trace is deleted, and correct ones are appended to the
-		//end. The trace_disp is only pushed back if the path is OK, meaning that the two lists should be in sync.
-		if(!calc_trace_displacements(trace_displacements, zero_pos, prob_pos, trace_points, *it)){
-			it = fix_spatial_path(prob_pos,it);
-		}else{
-			trace_disp.push_back(std::move(trace_displacements));
-			++it;
-		}
-	}
+		//If the calculation fails, we need to impose a delta on prob_pos, which will change the spatial path, meaning
+		//that we need to re-calculate it. The trace_disp is only pushed back together with the path, so that the two
+		//lists stay in sync.
+		if(!calc_trace_displacements(trace_displacements, zero_pos, prob_pos, trace_points, s_path)){
 
-	//Removes paths which are exactly the same after the spatial deltas, also remove the corresponding trace displacements
-	co_remove_duplicates(s_paths, trace_disp);  
-}
+			SpatialContractions contractions(prob_pos, s_path);
+			std::vector<int> contracted;
+
+			while(contractions.next(contracted)){
+				if(!solved.count(contracted)){
+					worklist.push_back(std::move(contracted));
+				}
+			}
 
-/// Takes an iterator to a problematic spatial spatial configuration, and the position vector which has to be zero for the config
-/// to be valid. It then removes the problematic trace (returning an iterator to the next element), and adds the fixed
-/// configurations to the end of the s_paths list.
+			continue;
+		}
 
-std::list< std::vector<int> >::iterator PMPath::fix_spatial_path(Position::pos &pos, std::list< std::vector<int> >::iterator it){
+		canonical.emplace_back(s_path);
 
-	std::list< std::vector<int> > new_spatials(1,*it);
-	spatial_contractions(pos, new_spatials);
+		if(!kept.insert(&canonical.back()).second){
+			canonical.pop_back();
+			continue;
+		}
 
-	s_paths.splice(s_paths.end(), std::move(new_spatials));
-	std::list< std::vector<int> >::iterator return_val = s_paths.erase(it);
+		dof.push_back(canonical.back().dof);
+		s_paths.push_back(std::move(s_path));
+		trace_disp.push_back(std::move(trace_displacements));
+	}
 
-	return return_val;
+	return dof;
 }
 
 /// Runs a simplified version of calc_trace_displacement, using the PM-config instead of the spatial path to check whether a 
 /// given temporal contraction is even possible. If the config survives this test, there exists a way to arrange the spatial
-/// path in such a way that it all works out, hence why we do fix_spatial_path in fill_trace_displacements, instead of 
+/// path in such a way that it all works out, hence why we contract the problematic spatial paths in fill_trace_displacements, instead of 
 /// deleting the configuration.
 
 bool PMPath::valid_multi_tr_path(const std::vector<Config> &cfgArray, const std::vector<int> &trace_points){
@@ -73,13 +177,28 @@ bool PMPath::valid_multi_tr_path(const std::vector<Config> &cfgArray, const std:
 /// whether there is a well defined way of doing so. If a trace ends up with two conflicting displacements for a single trace,
 /// the false is returned. The function also returns false if not all traces are displaced with respect to zero, as that means
 /// that two or more sets of traces are disconnected, and the contribution is already included in the exponensiation.
+///
+/// The traces linked so far are kept in a TraceDisplacementForest, and the displacements are given relative to trace 0.
 
 template <class PosType, class PathType>
 bool PMPath::calc_trace_displacements(std::vector<PosType> &rel_pos, const PosType &init_elem, PosType &prob_pos, const std::vector<int> &trace_points, 
 		const std::vector<PathType> &sp){
 
-	std::vector<int> disp_wrt(trace_points.size(),0); //List of which traces we are displaces with respect to
-	std::vector<char> disp_set(trace_points.size(),false); //Whether the trace displacement has been set
+	TraceDisplacementForest<PosType> forest(trace_points.size(), init_elem);
+
+	//The running sums of the spatial path within every trace, trace_sums[j] is the sum from the start of the trace up
+	//to and including j. The distances between the links below are differences of two of these.
+	std::vector<PosType> trace_sums;
+	trace_sums.reserve(path.size());
+
+	int tr_from = 0;
+	for(int tr_to : trace_points){
+		for(int j=tr_from; j<tr_to; j++){
+			trace_sums.push_back( (j == tr_from) ? init_elem : trace_sums.back() );
+			trace_sums.back() += sp[j];
+		}
+		tr_from = tr_to;
+	}
 
 	int from = 0; //trace lower limit
 	auto to = trace_points.begin(); //trace upper limit
@@ -94,97 +213,53 @@ bool PMPath::calc_trace_displacements(std::vector<PosType> &rel_pos, const PosTy
 			++i_tr_ind;
 		}
 
-		//First look for the corresponding link (temporal contractions)
-		int lnk = 0;
-		for(int j=i+1; j<path.size(); j++){
-			if(path[j] == -path[i]){
-				lnk = j;
-				break;
-			}
-		}
+		//First look up the corresponding link (temporal contractions)
+		int lnk = partner[i];
 		
 		//If the link is either below or is within the same trace, no displacement need to be set
-		if( (lnk == 0) or (lnk < *to) ) continue;
+		if( (lnk <= i) or (lnk < *to) ) continue;
 
-		int lnk_tr_ind = trace_index(lnk, trace_points);
+		int lnk_tr_ind = trace_id[lnk];
 
 		//The spatial distance between the two elements of the link (excluding the trace displacement)
 		PosType current_rel_pos(init_elem);
 
 		int border = (path[i] < 0) ? i+1 : i;
 
-		for(int j=from; j<border; j++){
-			current_rel_pos += sp[j];
+		if(border > from){
+			current_rel_pos += trace_sums[border-1];
 		}
 
 		border = (path[lnk] < 0) ? lnk+1 : lnk;
 
-		for(int j=trace_points[lnk_tr_ind-1]; j<border; j++){
-			current_rel_pos -= sp[j];
+		if(border > trace_points[lnk_tr_ind-1]){
+			current_rel_pos -= trace_sums[border-1];
 		}
 
-		//Which trace index lies at the bottom of the two traces
-		int i_root   = disp_set[i_tr_ind]   ? disp_wrt[i_tr_ind]   : i_tr_ind;
-		int lnk_root = disp_set[lnk_tr_ind] ? disp_wrt[lnk_tr_ind] : lnk_tr_ind;
-
-		//If they are displaced wrt the same trace, they can be compared
-		if(lnk_root == i_root){
-			current_rel_pos += rel_pos[i_tr_ind];
-			current_rel_pos -= rel_pos[lnk_tr_ind];
-
-			//If the displacement doesn't match the previous one, return false
-			if(!pos_is_zero(current_rel_pos)){
-				prob_pos = current_rel_pos;
-				return false;
-			}
-		}else{
-
-			//If they are displaced with respect to different traces, one of them needs to be moved.
-			//We move the one which has the highest disp_wrt-index, so that in the end, all traces
-			//should be displaced wrt 0.
-			int move_ind, targ_ind;
-
-			//The total displacement is the relative position plus the two individual
-			//displacement, taken in a direction depending on which trace we are moving
-			PosType tot_disp(init_elem);
-
-			if(i_root < lnk_root){
-				move_ind = lnk_root;
-				targ_ind = i_root;
-				tot_disp += rel_pos[i_tr_ind];
-				tot_disp += current_rel_pos;
-				tot_disp -= rel_pos[lnk_tr_ind];
-			}else{
-				move_ind = i_root;
-				targ_ind = lnk_root;
-				tot_disp -= rel_pos[i_tr_ind];
-				tot_disp -= current_rel_pos;
-				tot_disp += rel_pos[lnk_tr_ind];
-			}
-
-			//First move the current trace
-			rel_pos[move_ind]  = tot_disp;
-			disp_wrt[move_ind] = targ_ind;
-			disp_set[move_ind] = true;
-
-			//Then move all traces which were displaced with respect to the one just moved
-			for(int j=0; j<trace_points.size(); j++){
-				if(disp_wrt[j] == move_ind){
-					disp_wrt[j] = targ_ind;
-					rel_pos[j] += tot_disp;
-				}
-			}
+		//Either joins the groups of the two traces, or, if they are already in the same group, checks that the link
+		//agrees with their displacements. If not, current_rel_pos is the difference which would have to be zero.
+		if(!forest.link(i_tr_ind, lnk_tr_ind, current_rel_pos)){
+			prob_pos = current_rel_pos;
+			return false;
 		}
 	}
 
-	//Go through and check if all traces (except 0) are displaced. If not, the contribution is already
+	//Go through and check if all traces are displaced with respect to trace 0. If not, the contribution is already
 	//included in the exponensiation.
+	int root = forest.find(0);
+
 	for(int i=1; i<trace_points.size(); i++){
-		if(!disp_set[i]){
+		if(forest.find(i) != root){
 			return false;
 		}
 	}
 
+	for(int i=0; i<trace_points.size(); i++){
+		rel_pos[i] = init_elem;
+		rel_pos[i] += forest.displacement(i);
+		rel_pos[i] -= forest.displacement(0);
+	}
+
 	return true;
 }
 
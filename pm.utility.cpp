@@ -1,5 +1,5 @@
 //Created: 06-03-2014
-//Modified: Mon 18 Aug 2014 12:08:55 CEST
+//Modified: Sat 17 Oct 2026 21:40:12 CEST
 //Author: Jonas R. Glesaaen (jonas@glesaaen.com)
 
 #include"pm.utility.h"
@@ -19,97 +19,217 @@ int trace_index(int n, const std::vector<int> &trace_points){
 
 void rectify_spatial_path(Position::pos &pos, PMPath &p, std::list< std::vector<int> >::iterator it){
 
-	std::list< std::vector<int> > new_spatials(1,*it);
-	spatial_contractions(pos, new_spatials);
+	SpatialContractions contractions(pos, *it);
+	std::vector<int> s_path;
+
+	while(contractions.next(s_path)){
+		p.s_paths.push_back(std::move(s_path));
+	}
 
 	p.s_paths.erase(it);
-	p.s_paths.splice(p.s_paths.end(), std::move(new_spatials));
 }
 
 template <class PosType>
-PosType calculate_position(int index, const PosType &zero_pos, const std::vector<int> &s_path){
+std::vector<PosType> position_table(int length, const PosType &zero_pos, const std::int8_t *s_path){
 
-	PosType ret_pos(zero_pos);
+	std::vector<PosType> table;
+	table.reserve(length);
 
-	for(int i=0; i<index; i++){
-		ret_pos += s_path[i];
+	table.push_back(zero_pos);
+
+	for(int i=1; i<length; i++){
+		table.push_back(table.back());
+		table.back() += s_path[i-1];
 	}
 
-	return ret_pos;
+	return table;
 }
 
 template <class PosType>
-PosType calculate_position(int index, const std::vector<int> &trace_points, const std::vector<int> &s_path, const std::vector<PosType> &tr_pos){
+std::vector<PosType> position_table(const std::vector<int> &trace_points, const std::int8_t *s_path, const std::vector<PosType> &tr_pos){
+
+	std::vector<PosType> table;
+	table.reserve(trace_points.back());
 
-	int tr_ind = trace_index(index,trace_points);
-	int from = (tr_ind == 0) ? 0 : trace_points[tr_ind-1];
+	int from = 0;
+	for(int tr_ind=0; tr_ind<trace_points.size(); tr_ind++){
 
-	PosType ret_pos(tr_pos[tr_ind]);
+		int to = trace_points[tr_ind];
 
-	for(int i=from; i<index; i++){
-		ret_pos += s_path[i];
+		if(from == to){
+			continue;
+		}
+
+		table.push_back(tr_pos[tr_ind]);
+
+		for(int i=from+1; i<to; i++){
+			table.push_back(table.back());
+			table.back() += s_path[i-1];
+		}
+
+		from = to;
 	}
 
-	return ret_pos;
+	return table;
 }
 
-void replace_in_vector(std::vector<int> &v, int replace_elem, int replace_with){
-	
-	for(int &i : v){
-		if(abs(i) == replace_elem){
-			i = Utility::sign(i) * replace_with;
+CanonicalSpatialPath::CanonicalSpatialPath(const std::vector<int> &s_path) : labels(s_path.size()), dof(0){
+
+	int max_label = 0;
+	for(int x : s_path){
+		max_label = std::max(max_label, abs(x));
+	}
+
+	//The new name of every label, and which signs of it have been counted towards the degrees of freedom
+	std::vector<int> relabel(max_label+1, 0);
+	std::vector<char> seen_sign(2*max_label+1, false);
+
+	int next_label = 0;
+
+	for(int i=0; i<s_path.size(); i++){
+
+		int x = s_path[i];
+		int label = abs(x);
+
+		if(!seen_sign[max_label + x]){
+			seen_sign[max_label + x] = true;
+			++dof;
+		}
+
+		if(label == 0){
+			labels[i] = 0;
+			continue;
+		}
+
+		if(relabel[label] == 0){
+			relabel[label] = ++next_label;
 		}
+
+		labels[i] = Utility::sign(x) * relabel[label];
 	}
 }
 
-void spatial_contractions(Position::pos &p, std::list< std::vector<int> > &spatial_paths){
+SpatialContractions::IndexPartition::IndexPartition(int dim) : parent(dim+1){
 
-	int start = 0;
-	int end = p.size();
+	for(int i=0; i<=dim; ++i){
+		parent[i] = i;
+	}
+}
+
+std::vector<int> SpatialContractions::IndexPartition::resolve(const std::vector<int> &s_path) const{
+
+	std::vector<int> resolved(s_path);
+
+	for(int &i : resolved){
+		int label = abs(i);
 
-	while(start != end and p[start] == 0){
-		++start;
+		if(label < parent.size()){
+			i = Utility::sign(i) * find(label);
+		}
 	}
 
-	if(start == end){
-		return;
+	return resolved;
+}
+
+SpatialContractions::SpatialContractions(const Position::pos &p, const std::vector<int> &s_path)
+	: p(p), s_path(s_path), partition(p.size()), started(false), finished(false){}
+
+/// Gives the next contracted spatial path in out, returning false when there are no more. The first call descends
+/// to the first contraction, every later one backtracks to the deepest pair with another partner left and descends
+/// from there.
+
+bool SpatialContractions::next(std::vector<int> &out){
+
+	if(finished){
+		return false;
 	}
 
-	int init_sign = Utility::sign(p[start]);
-	std::vector<int> init_spatial(spatial_paths.back());
+	if(started and !backtrack()){
+		finished = true;
+		return false;
+	}
 
-	bool first_used = false;
+	started = true;
+	descend();
 
-	for(int i=start+1; i<end; i++){
+	out = partition.resolve(s_path);
+	return true;
+}
 
-		int i_sign = Utility::sign(p[i]);
+/// Pairs the first non-zero entry of p with one of opposite sign until p is zero. Every position has such a pair as
+/// long as the total spatial path is zero, so a dead end means the input was invalid.
 
-		if(init_sign == -i_sign){
+void SpatialContractions::descend(){
 
-			if(first_used){
-				spatial_paths.push_back(init_spatial);
-			}else{
-				first_used = true;
-			}
+	int end = p.size();
 
-			replace_in_vector(spatial_paths.back(), i + 1, start + 1);
+	while(true){
 
-			int i_tmp = p[i];
-			p[start] += i_tmp; p[i] = 0;
+		int start = 0;
+		while(start != end and p[start] == 0){
+			++start;
+		}
 
-			spatial_contractions(p, spatial_paths);
+		if(start == end){
+			return;
+		}
 
-			p[start] -= i_tmp; p[i] = i_tmp;
+		stack.push_back(Frame{start, start, 0});
 
+		if(!advance(stack.back())){
+			throw Error("The spatial vector isn't zero in the end");
 		}
 	}
+}
+
+/// Undoes the pairings from the top of the stack until one of them can be paired with the next partner instead.
+/// Returns false once the stack is empty, meaning that all contractions have been given.
+
+bool SpatialContractions::backtrack(){
+
+	while(!stack.empty()){
 
-	if(!first_used){
-		throw Error("The spatial vector isn't zero in the end");
+		Frame &frame = stack.back();
+
+		p[frame.start] -= frame.value;
+		p[frame.partner] = frame.value;
+		partition.release(frame.partner + 1);
+
+		if(advance(frame)){
+			return true;
+		}
+
+		stack.pop_back();
+	}
+
+	return false;
+}
+
+/// Pairs frame.start with the next index after frame.partner which has the opposite sign
+
+bool SpatialContractions::advance(Frame &frame){
+
+	int init_sign = Utility::sign(p[frame.start]);
+
+	for(int i=frame.partner+1; i<p.size(); i++){
+
+		if(init_sign == -Utility::sign(p[i])){
+
+			frame.partner = i;
+			frame.value = p[i];
+
+			p[frame.start] += frame.value;
+			p[i] = 0;
+			partition.identify(i + 1, frame.start + 1);
+
+			return true;
+		}
 	}
+
+	return false;
 }
 
 }; //Namespace hop
 
-template Position::pos hop::calculate_position(int,const Position::pos &,const std::vector<int> &);
-template Position::pos hop::calculate_position(int,const std::vector<int>&,const std::vector<int>&,const std::vector<Position::pos>&);
+template std::vector<Position::pos> hop::position_table(int,const Position::pos &,const std::int8_t *);
+template std::vector<Position::pos> hop::position_table(const std::vector<int>&,const std::int8_t *,const std::vector<Position::pos>&);
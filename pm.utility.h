@@ -1,5 +1,5 @@
 //Created: 06-03-2014
-//Modified: Mon 18 Aug 2014 11:54:59 CEST
+//Modified: Sat 17 Oct 2026 23:48:19 CEST
 //Author: Jonas R. Glesaaen (jonas@glesaaen.com)
 
 #ifndef PM_UTILITY_H
@@ -12,6 +12,9 @@
 #include<vector>
 #include<list>
 #include<set>
+#include<unordered_set>
+
+#include<boost/functional/hash.hpp>
 
 #include"pm.typedef.h"
 #include"pm.paths.h"
@@ -23,22 +26,115 @@ int trace_index(int,const std::vector<int>&);
 inline bool pos_is_zero(const Position::pos &pos) {return pos.is_zero();};
 inline bool pos_is_zero(const int &pos) {return pos == 0;};
 
+/// The spatial positions of every element of a spatial path, found with a single running sum. The first version
+/// starts from zero_pos and sums over the whole path, the second starts every trace at its trace displacement and
+/// only sums within the trace.
+
 template <class PosType>
-PosType calculate_position(int,const PosType&,const std::vector<int>&);
+std::vector<PosType> position_table(int,const PosType &zero_pos,const std::int8_t*);
 
 template <class PosType>
-PosType calculate_position(int,const std::vector<int>&,const std::vector<int>&,const std::vector<PosType>&);
+std::vector<PosType> position_table(const std::vector<int>&,const std::int8_t*,const std::vector<PosType> &tr_pos);
 
-void replace_in_vector(std::vector<int> &, int replace_elem, int replace_with);
+//// Goes through all the ways of identifying the indecies of a spatial path which make the position p zero, one
+//// contracted spatial path at a time. Every step pairs the first non-zero entry of p with one of opposite sign, and
+//// the pairs are kept on an explicit stack so that the enumeration can stop after every path and be resumed by the
+//// next call to next(). The identifications are kept in an IndexPartition and only written out once a full spatial
+//// path is found.
 
-void spatial_contractions(Position::pos&, std::list< std::vector<int> >&);
+class SpatialContractions
+{
+private:
+	//// The identified index labels 1..dim, as a union-find. The label which an index is merged into is always a
+	//// root, as it is the first non-zero entry of the position, which can no longer be merged into anything else.
+	//// The trees are therefore flat, and both identifying and undoing it costs O(1).
+	class IndexPartition
+	{
+	private:
+		std::vector<int> parent;
 
-template<class InputIt>
-inline int degrees_of_freedom(InputIt first, InputIt last){
+	public:
+		IndexPartition(int dim);
 
-	std::set<int> ind_set(first,last);
-	return ind_set.size();
-}
+		int find(int label) const
+		{
+			while(parent[label] != label)
+				label = parent[label];
+
+			return label;
+		};
+
+		void identify(int label, int root) {parent[label] = root;};
+		void release(int label) {parent[label] = label;};
+
+		//Writes out the spatial path with every index replaced by the root of its label
+		std::vector<int> resolve(const std::vector<int>&) const;
+	};
+
+	//The index paired with start, and the entry of p it had before the pairing
+	struct Frame
+	{
+		int start;
+		int partner;
+		int value;
+	};
+
+	Position::pos p;
+	std::vector<int> s_path;
+
+	IndexPartition partition;
+	std::vector<Frame> stack;
+
+	bool started, finished;
+
+	void descend();
+	bool backtrack();
+	bool advance(Frame&);
+
+public:
+	SpatialContractions(const Position::pos &p, const std::vector<int> &s_path);
+
+	bool next(std::vector<int> &out);
+};
+
+//// Hashes and compares the objects pointed to, so that the elements of a container can be put in a hash set without
+//// being copied. Used by the remove_duplicates functions.
+
+template <class Type>
+struct PointeeHash
+{
+	std::size_t operator()(const Type *x) const {return boost::hash<Type>()(*x);};
+};
+
+template <class Type>
+struct PointeeEqual
+{
+	bool operator()(const Type *lhs, const Type *rhs) const {return *lhs == *rhs;};
+};
+
+template <class Type>
+using PointeeSet = std::unordered_set<const Type*, PointeeHash<Type>, PointeeEqual<Type> >;
+
+//// A spatial path with its indecies renumbered in the order they first appear, keeping the signs. Two paths which
+//// only differ by the naming of the summed indecies have the same canonical form, so that they can be compared
+//// with a single vector compare. The degrees of freedom of the path, the number of distinct entries, are counted
+//// in the same pass and kept alongside.
+
+struct CanonicalSpatialPath
+{
+	std::vector<int> labels;
+	int dof;
+
+	CanonicalSpatialPath(const std::vector<int>&);
+
+	friend bool operator==(const CanonicalSpatialPath &lhs, const CanonicalSpatialPath &rhs) {return lhs.labels == rhs.labels;};
+};
+
+inline std::size_t hash_value(const CanonicalSpatialPath &c) {return boost::hash_range(c.labels.begin(), c.labels.end());};
+
+/// The remove_duplicates functions remove every element which is equal to one in front of it, keeping the first
+/// occurrence and the order of the rest. The elements seen so far are kept in a hash set, so that it takes linear
+/// time instead of comparing every pair.
 
 template <class Type>
 inline void remove_duplicates(typename std::vector<Type> &v){
@@ -47,18 +143,28 @@ inline void remove_duplicates(typename std::vector<Type> &v){
 		return;
 	}
 
-	for(int i=0; i<v.size(); i++){
-		
-		typename std::vector<Type>::iterator it = v.begin() + i + 1;
+	//Moving the elements would invalidate the pointers in the set, so the duplicates are first found and then removed
+	PointeeSet<Type> seen;
+	seen.reserve(v.size());
+
+	std::vector<char> keep(v.size());
 
-		while(it != v.end()){
-			if(*it == v[i]){
-				it = v.erase(it);
-			}else{
-				++it;
+	for(std::size_t i=0; i<v.size(); i++){
+		keep[i] = seen.insert(&v[i]).second;
+	}
+
+	std::size_t to = 0;
+
+	for(std::size_t i=0; i<v.size(); i++){
+		if(keep[i]){
+			if(to != i){
+				v[to] = std::move(v[i]);
 			}
+			++to;
 		}
 	}
+
+	v.erase(v.begin() + to, v.end());
 }
 
 template <class Type>
@@ -68,20 +174,23 @@ inline void remove_duplicates(typename std::list<Type> &l){
 		return;
 	}
 
-	for(typename std::list<Type>::iterator it_i = l.begin(); it_i != l.end(); ++it_i){
+	PointeeSet<Type> seen;
+	seen.reserve(l.size());
 
-		typename std::list<Type>::iterator it_j = it_i; ++it_j;
+	typename std::list<Type>::iterator it = l.begin();
 
-		while(it_j != l.end()){
-			if(*it_i == *it_j){
-				it_j = l.erase(it_j);
-			}else{
-				++it_j;
-			}
+	while(it != l.end()){
+		if(seen.insert(&*it).second){
+			++it;
+		}else{
+			it = l.erase(it);
 		}
 	}
 }
 
+/// Removes the duplicates of l as remove_duplicates does, together with the elements at the same positions in co_l,
+/// which is expected to be as long as l.
+
 template <class CheckType, class CoType>
 inline void co_remove_duplicates(typename std::list<CheckType> &l, typename std::list<CoType> &co_l){
 
@@ -89,25 +198,71 @@ inline void co_remove_duplicates(typename std::list<CheckType> &l, typename std:
 		return;
 	}
 
-	typename std::list<CoType>::iterator it_co_i = co_l.begin();
+	PointeeSet<CheckType> seen;
+	seen.reserve(l.size());
+
+	typename std::list<CheckType>::iterator it = l.begin();
+	typename std::list<CoType>::iterator it_co = co_l.begin();
+
+	while(it != l.end()){
+		if(seen.insert(&*it).second){
+			++it;
+			++it_co;
+		}else{
+			it = l.erase(it);
+			it_co = co_l.erase(it_co);
+		}
+	}
+}
+
+/// Removes every spatial path which is a relabelling of one in front of it, together with the elements at the same
+/// positions in co_l (if given), and returns the degrees of freedom of the remaining paths in order.
+
+template <class CoType>
+inline std::vector<int> co_remove_relabelled_duplicates(std::list< std::vector<int> > &s_paths, std::list<CoType> *co_l){
+
+	std::vector<CanonicalSpatialPath> canonical;
+	canonical.reserve(s_paths.size());
+
+	for(const std::vector<int> &s_path : s_paths){
+		canonical.emplace_back(s_path);
+	}
+
+	PointeeSet<CanonicalSpatialPath> seen;
+	seen.reserve(canonical.size());
 
-	for(typename std::list<CheckType>::iterator it_i = l.begin(); it_i != l.end(); ++it_i){
+	std::vector<int> dof;
+	dof.reserve(canonical.size());
+
+	auto it = s_paths.begin();
+	typename std::list<CoType>::iterator it_co;
+
+	if(co_l){
+		it_co = co_l->begin();
+	}
 
-		typename std::list<CheckType>::iterator it_j = it_i; ++it_j;
-		typename std::list<CoType>::iterator it_co_j = it_co_i; ++it_co_j;
+	for(const CanonicalSpatialPath &c : canonical){
+		if(seen.insert(&c).second){
+			dof.push_back(c.dof);
+			++it;
 
-		while(it_j != l.end()){
-			if(*it_i == *it_j){
-				it_j = l.erase(it_j);
-				it_co_j = co_l.erase(it_co_j);
-			}else{
-				++it_j;
-				++it_co_j;
+			if(co_l){
+				++it_co;
 			}
-		}
+		}else{
+			it = s_paths.erase(it);
 
-		++it_co_i;
+			if(co_l){
+				it_co = co_l->erase(it_co);
+			}
+		}
 	}
+
+	return dof;
+}
+
+inline std::vector<int> remove_relabelled_duplicates(std::list< std::vector<int> > &s_paths){
+	return co_remove_relabelled_duplicates< std::vector<int> >(s_paths, nullptr);
 }
 
 }; //Namespace hop
@@ -5,10 +5,15 @@
 #include"pmn.h"
 
 #include"std_libs/subset_sum.hpp"
+#include"std_libs/necklaces.hpp"
+#include"std_libs/task_pool.hpp"
+
+#include"run_statistics.hpp"
 
 namespace hop{
 
-PMN::PMN(int _order) : order(_order), configurations(_order/2) {
+PMN::PMN(int _order) : order(_order), configurations(_order/2), statistics(nullptr),
+	symmetry_reduction(false) {
 
 	if(_order < 2 or _order%2 != 0){
 		char errorMsg[256];
@@ -27,62 +32,36 @@ WilsonStringPtr::~WilsonStringPtr(){
 
 }
 
-/// Go through and fill up the list "configurations". The list is a list of vectors of PMPair. The vectors contains all unique
+/// Go through and fill up the list "configurations". The list is a list of vectors of PMConfig. The vectors contains all unique
 /// orderings of p's and m's, as well as a combinatorial factor as e.q. pmpm and mpmp is the same configuration due to the trace.
-/// So the list is over orderings. If allOrders = true, and say order = 6, then the list has three elements, configurations to
-/// order k^2, k^4 and k^6. If allOrders = false (which it probably never will be for any other purpose than debugging), then 
-/// the list will always be one element long, and that is the specified order. The fillConfigs-function basically fills up the list
-/// and the vector with all unique configurations, and counts the configs which are equal.
+/// So the list is over orderings, e.g. for order = 6 the list has three elements, configurations to order k^2, k^4 and k^6.
+/// The unique orderings are exactly the balanced binary necklaces, which are generated directly by FixedDensityNecklaces
+/// (p <-> 0, m <-> 1). The necklaces come in lexicographic order, are already on the form p...m, and each carries the
+/// number of rotations which are equal to it, which is the count the configuration would have had in a full enumeration.
 
 void PMN::fillConfigs(){
 
+	RunStatistics::StageTimer timer(statistics, RunStatistics::FillConfigs);
+
 	for(int i=0; i < (order/2); i++){
 
 		int kappa = (i+1)*2;
-		
-		//First initialise all configurations, and add them to a vector. As there must be an equal number of p's and m's
-		//there are binominal(n,n/2) of these.
-		int validConfigs = Utility::BinomialCoefficients<int>(kappa, kappa/2);
-		std::vector<PMConfig> allConfigs(validConfigs,PMConfig(kappa));
-
-		//The configurations are filled using a recursive function fillAllConfigs, which is explained in more detail later.
-		//After this the vector allConfigs should be filled. At e.q. k^4 it is filled with ppmm, pmpm, pmmp, mpmp, mmpp, mppm
-		fillAllConfigs(0,(kappa/2+1),kappa/2,allConfigs,0);
-
-		//Do a superficial ordering of all elements so that they all start with a p and end with an m
-		for(auto &conf : allConfigs){
-			conf.ordering();
-		}
 
-		//Add an emply std::vector<PMPair> to the back of the configurations-list
-		//configurations.emplace_back;
+		FixedDensityNecklaces<> necklaceCreator(kappa, kappa/2);
 
-		for(int j=0; j<validConfigs; j++){
+		for(const auto &necklace : necklaceCreator.calculate()){
 
-			bool incr = false;
-			//Check through the vector of PMPairs and see if the configuration is already present or not
-			for(auto &conf : configurations[i]){
+			configurations[i].emplace_back(kappa);
 
-				//If it is present, add to the count and move on. The overloaded equality operator
-				//also checks all permutations
-				if(allConfigs[j] == conf){
-					conf++;
-					incr=true;
-					break;
-				}
+			for(int j=0; j<kappa; j++){
+				configurations[i].back()[j] = (necklace.word[j] == 0) ? Cfg_P : Cfg_M;
 			}
 
-			//If it wasn't found, add it
-			if(!incr){
-				configurations[i].push_back(allConfigs[j]);
-				configurations[i].back().finalise();
-			}
-		}
+			configurations[i].back().finalise();
 
-		//Then add its exponential combinatoric factor: -2/order, the 2 from the gamma-trace
-		for(auto &conf : configurations[i]){
-			conf *= (PM::pref_type)-2;
-			conf /= kappa;
+			//Add its multiplicity and its exponential combinatoric factor: -2/order, the 2 from the gamma-trace
+			configurations[i].back() *= (PM::pref_type)(-2*necklace.multiplicity);
+			configurations[i].back() /= (PM::pref_type)kappa;
 		}
 	}
 
@@ -93,24 +72,10 @@ void PMN::fillConfigs(){
 
 	int first_multi_trace = configurations.back().size(); //The number of single trace configurations
 
-	//Here we use the subset_sum function defined in std_libs/std_funcs.h. It takes a list of positive integers to 
-	//sum and a target, then it finds all possible ways to sum the numbers in the subset so that the result is the target.
-	//E.g. {2,4} to 6 gives 2 lists: {2,2,2},{2,4}
-	std::vector<int> subset(order/2 - 1);
-
-	for(int i=0; i < (order/2-1); i++){
-		subset[i] = (i+1)*2;
-	}
-
-	SubsetSum<> sumCreator(order, subset);
-	std::list< std::vector<int> > combinations = sumCreator.calculate();
-
-	//A comb is now a list of which PMConfig's we want to construct the multi-trace contrib
-	for(auto &comb : combinations){
-		configurations.back().emplace_back(order);
-		
-		std::list< std::vector<int> > send_set;    //This is a parameter sent between the recursive calls to calculate 
-		fill_multi_config(comb,0,0,send_set); 		//the combinatoric factor in the end
+	//The multi-trace configurations are built one at a time by the MultiTraceGenerator, directly from the
+	//single-trace configurations of the lower orders
+	for(MultiTraceGenerator multi_trace(configurations, order); !multi_trace; ++multi_trace){
+		configurations.back().push_back(multi_trace.config());
 	}
 
 	//An iterator which starts at the first multi trace
@@ -120,111 +85,231 @@ void PMN::fillConfigs(){
 	multi_trace_begin_const = multi_trace_begin;
 }
 
-/// This is a private, recursive member function which takes in the vector of configurations "conf" and 
-/// calculates all possible orderings of p and m. 'left' is how many p's are left to place (as
-/// the PMConfig is initialised with all members being m), and the counter is the position of
-/// the vector we're at after having added all the new members
+/// Reduces the configurations of the highest order to a single shard of the full run, so that one order can be split
+/// across independent processes. Shard shard_index of shard_count keeps every shard_count'th configuration, starting at
+/// shard_index. As the configurations are always generated in the same order, the selection is stable between runs,
+/// and the shards together cover every configuration exactly once. The configurations of the lower orders are kept as
+/// they are used to build the multi-trace configurations.
 
-int PMN::fillAllConfigs(int from, int to, int left, std::vector<PMConfig> &conf, int counter){
+void PMN::selectShard(int shard_index, int shard_count){
 
-	//First save the initial configuration to a temporary vector, as we will need it
-	PMConfig initConf(conf[counter]);
+	if(shard_count < 1 or shard_index < 0 or shard_index >= shard_count){
+		char errorMsg[256];
+		sprintf(errorMsg,"In function PMN::selectShard():\n"
+				"Invalid shard %d of %d, the index has to lie between 0 and the number of shards",shard_index,shard_count);
+		throw PMNError(errorMsg);
+	}
 
-	//If there is only one p left to place, place one at every possible location and return
-	if(left == 1){
-		for(int i=from; i<to; i++){
+	if(configurations.empty() or configurations.back().empty()){
+		throw PMNError("In function PMN::selectShard():\n"
+				"Cannot select a shard of the configurations until they have have been filled.\n"
+				"Use PMN::fillConfigs() first.");
+	}
 
-			if(i>from){
-				conf[counter] = initConf;
-			}
-			
-			conf[counter][i] = Cfg_P;
-			counter++;
-		}
-	}else{
-		for(int i=from; i<to; i++){
+	std::vector<PMConfig> selected;
 
-			if(i>from){
-				conf[counter] = initConf;
-			}
+	for(std::size_t i = shard_index; i < configurations.back().size(); i += shard_count){
+		selected.push_back(configurations.back()[i]);
+	}
 
-			conf[counter][i] = Cfg_P;
-			
-			//If there are more to place, place one and call itself. The to
-			//argument is such that if you have 2 left to place, you cannot go
-			//to the end of the array, only to the second last element (as there
-			//must be room for the last p)
-			counter = fillAllConfigs(i+1,to+1,left-1,conf,counter);
+	configurations.back().swap(selected);
+}
+
+/// Sets up the generator at the first multi-trace configuration. To find which orders to combine we use the SubsetSum
+/// class defined in std_libs/subset_sum.hpp. It takes a list of positive integers to sum and a target, then it finds all
+/// possible ways to sum the numbers in the subset so that the result is the target. E.g. {2,4} to 6 gives 2 lists:
+/// {2,2,2},{2,4}. The configurations of the highest order itself are not used, as they are single-trace.
+
+MultiTraceGenerator::MultiTraceGenerator(const std::vector< std::vector<PMConfig> > &configurations, int order)
+	: configurations(configurations), order(order) {
+
+	if(order > 2){
+		std::vector<int> subset(order/2 - 1);
+
+		for(int i=0; i < (order/2-1); i++){
+			subset[i] = (i+1)*2;
 		}
+
+		SubsetSum<> sumCreator(order, subset);
+		combinations = sumCreator.calculate();
+	}
+
+	current_comb = combinations.begin();
+
+	if(current_comb != combinations.end()){
+		indices.resize(current_comb->size());
+		reset_indices_from(0);
+	}
+}
+
+/// The products are unordered, so for a run of factors of the same order the configuration indices never decrease,
+/// e.g. ppmm.pmpm is generated but pmpm.ppmm isn't. Factors of a different order than the previous start from the
+/// first configuration of their order.
+
+int MultiTraceGenerator::first_index(int factor) const {
+
+	if(factor > 0 and (*current_comb)[factor] == (*current_comb)[factor-1]){
+		return indices[factor-1];
 	}
 
-	return counter;
+	return 0;
+}
+
+void MultiTraceGenerator::reset_indices_from(int factor){
 
+	for(int i=factor; i < indices.size(); i++){
+		indices[i] = first_index(i);
+	}
 }
 
-/// A private recursive function which calculated the multi-trace configurations. To do this, it takes a vector containing which
-/// lower level pmConfigs to use. E.g. {2,2,2} results in a pm.pm.pm. It internally sums over all PMConfigs of a given order, and
-/// passes the unfinished multi-trace PMConfig to the next level of recursion. In between calls it saves which configurations has
-/// been saved to the elements-list, which is also passed on, then used by the last recursive call to calculate the combinatorial
-/// factor
+/// Moves on to the next configuration. The indices are incremented like an odometer, starting at the last factor, and
+/// once all indices are exhausted the generator moves on to the next combination of orders.
+
+void MultiTraceGenerator::operator++(){
+
+	if(current_comb == combinations.end()){
+		return;
+	}
+
+	for(int i = indices.size() - 1; i >= 0; i--){
+		if(indices[i] + 1 < configs_of_order((*current_comb)[i]).size()){
+			indices[i]++;
+			reset_indices_from(i+1);
+			return;
+		}
+	}
 
-void PMN::fill_multi_config(const std::vector<int> &v, int v_ind, int from, std::list< std::vector<int> > elements){
+	++current_comb;
 
-	PMConfig initConf(configurations.back().back());
+	if(current_comb != combinations.end()){
+		indices.resize(current_comb->size());
+		reset_indices_from(0);
+	}
+}
 
-	bool used = false; //Whether or not we have used the first element
-	int c_ind = v[v_ind]/2 - 1; //This is where in the configurations vector we find the order of v[v_ind]
+/// The multiplicative factor from re-ordering is #ofElements!/(product of all individually equal elements!). The
+/// numerator is cancelled by the factorial from the series expansion of the exponential, this is the denominator.
 
-	//Loop through all configurations of the given order. E.g. if v_ind is 4 (kappa^4), then c_ind is 1 and 
-	//the for-loop loops over pmpm and ppmm
-	for(int i=from; i < configurations[c_ind].size(); i++){
+PM::pref_type MultiTraceGenerator::denominator() const {
 
-		auto send_set = elements;
+	PM::pref_type pref_denom = 1;
+	int run_length = 1;
 
-		//If we choose the exact same element (both in terms of v_ind and i) we increment how many times
-		//we have used that combination to later be able to calculate the combinatorial factor.
-		if(send_set.empty()){
-			send_set.emplace_back(std::vector<int>({v[v_ind],i,1}));
-		}else if( (send_set.back()[0] == v[v_ind]) and (send_set.back()[1] == i) ){
-			send_set.back()[2]++;
+	for(int i=1; i <= indices.size(); i++){
+		if(i < indices.size() and (*current_comb)[i] == (*current_comb)[i-1] and indices[i] == indices[i-1]){
+			run_length++;
 		}else{
-			send_set.emplace_back(std::vector<int>({v[v_ind],i,1}));
+			pref_denom *= Utility::Factorial<PM::pref_type>(run_length);
+			run_length = 1;
 		}
+	}
+
+	return pref_denom;
+}
+
+/// Builds the current multi-trace configuration. The multiplication operator of PMConfig fills in the back of the
+/// configuration, updates the trace_points list and multiplies the prefactors.
+
+PMConfig MultiTraceGenerator::config() const {
+
+	PMConfig conf(order);
+
+	for(int i=0; i < indices.size(); i++){
+		conf *= factor(i);
+	}
+
+	conf /= denominator();
+
+	return conf;
+}
+
+/// Populates and gauge integrates the configurations in [begin, end), timing every stage if there are statistics to
+/// update. A representative keeps a copy of its temporal links until all its partners have been populated. With a
+/// TaskPool, the configurations whose representative is in the same range have to wait until the representatives
+/// are done, so they are run in a second round.
+
+void PMN::populateConfigs(std::size_t begin, std::size_t end, Utility::TaskPool *pool){
+
+	std::vector<PMConfig> &confs = configurations.back();
+
+	auto populate = [this, &confs](std::size_t i, Utility::TaskPool *pool) {
 
-		//If we have used the first element, add another one
-		if(used){
-			configurations.back().emplace_back(initConf);
+		PMConfig &conf = confs[i];
+		const SymmetryImage &image = symmetry_images[i];
+
+		{
+			RunStatistics::StageTimer timer(statistics, RunStatistics::TemporalPaths);
+
+			if(image.image >= 0){
+				conf.map_temporal(image_links[image.image], image.position_map);
+			}else{
+				conf.fill_temporal(pool);
+
+				if(partners_left[i] > 0){
+					conf.temporalLinks(image_links[i]);
+				}
+			}
 		}
 
+		{
+			RunStatistics::StageTimer timer(statistics, RunStatistics::SpatialPaths);
+			conf.fill_delta();
+		}
 
-		//The multiplication operator is overloaded so that it fills in the back if the right hand side
-		//is shorter than the right hand side. It also updates the trace_points list
-		configurations.back().back() *= configurations[c_ind][i];
+		{
+			RunStatistics::StageTimer timer(statistics, RunStatistics::GaugeIntegrate);
+			conf.gaugeIntegrate();
+		}
 
-		//If there are more elements, recurse
-		if( (v_ind + 1) != v.size()){
-			fill_multi_config(v,v_ind+1,i,send_set);
-		}else{
-			//Else, calculate the multiplicative factor from re-ordering. Which is #ofElements!/(product of all
-			//individually equal elements!). The numerator is cancelled by the factorial from the series expansion of
-			//the exponential.
-			PM::pref_type pref_denom = 1;
-			for(auto &c_list : send_set){
-				pref_denom *= Utility::Factorial<PM::pref_type>(c_list[2]);
+		if(statistics){
+			std::uint64_t spatial_paths = 0, wilson_strings = 0;
+
+			for(const PMPath &p : conf.paths){
+				spatial_paths += p.spatial.size();
+				wilson_strings += p.w.size();
 			}
 
-			configurations.back().back() /= pref_denom;
+			statistics->addPaths(conf.paths.size());
+			statistics->addSpatialPaths(spatial_paths);
+			statistics->addWilsonStrings(wilson_strings);
+			statistics->configDone();
+		}
+	};
+
+	if(pool == nullptr){
+		for(std::size_t i = begin; i < end; i++){
+			populate(i, nullptr);
+		}
+
+		return;
+	}
+
+	for(int round = 0; round < 2; round++){
+
+		Utility::TaskPool::Group group(*pool);
+
+		for(std::size_t i = begin; i < end; i++){
+			bool waits_for_image = (symmetry_images[i].image >= static_cast<std::ptrdiff_t>(begin));
+
+			if(waits_for_image == (round == 1)){
+				group.run([&populate, i, pool]() {populate(i, pool);});
+			}
 		}
 
-		used = true;
+		group.wait();
 	}
 }
 
 /// Simple collective function which itterates through all the PM-Configurations and fills in all
 /// possible spatial and temporal paths they can take. At the moment, it also removes duplicates
-/// and does the gauge integral.
+/// and does the gauge integral. Every PMConfig is independent, so with more than one thread the
+/// configurations are handed to a TaskPool, which is also used to split the temporal recursion of every PMConfig
+/// so that a single large configuration does not stall the run. The results stay within the PMConfigs themselves,
+/// so the subsequent print() and collect() still walk them in the same order as for the serial run. With the symmetry
+/// reduction turned on, the temporal paths of symmetry partners are mapped from their representative (see
+/// pmn.symmetry.cpp).
 
-void PMN::fillPaths(){
+void PMN::fillPaths(int number_of_threads){
 
 	if(configurations.empty() or configurations.back().empty()){
 		throw PMNError("In function PMN::fillPaths():\n"
@@ -232,11 +317,192 @@ void PMN::fillPaths(){
 				"Use PMN::fillConfigs() first.");
 	}
 
-	for(auto &conf : configurations.back()){
-		conf.populatePaths();
-		conf.gaugeIntegrate();
+	if(number_of_threads < 1){
+		throw PMNError("In function PMN::fillPaths():\n"
+				"The number of threads must be at least one.");
+	}
+
+	std::unique_ptr<Utility::TaskPool> pool;
+	if(number_of_threads > 1){
+		pool.reset(new Utility::TaskPool(number_of_threads));
+	}
+
+	if(statistics){
+		statistics->startConfigs(configurations.back().size());
+	}
+
+	findSymmetryImages(0);
+	populateConfigs(0, configurations.back().size(), pool.get());
+
+	for(std::size_t i = 0; i < configurations.back().size(); i++){
+		releaseConfig(i);
+	}
+}
+
+/// Sizes the run without doing it: every configuration goes through the same temporal recursion, spatial paths and
+/// gauge integral permutations as in fillPaths(), but one temporal path at a time, and only the number of paths,
+/// spatial paths and WilsonStrings is kept (see PMConfig::countPaths()). Nothing is printed or collected. With more
+/// than one thread the configurations are counted in parallel. The symmetry reduction is not used, as it only
+/// saves the temporal recursion, which is not where the time of a count goes.
+
+PathCount PMN::countPaths(int number_of_threads){
+
+	if(configurations.empty() or configurations.back().empty()){
+		throw PMNError("In function PMN::countPaths():\n"
+				"Cannot count the paths of the configurations until they have have been filled.\n"
+				"Use PMN::fillConfigs() first.");
+	}
+
+	if(number_of_threads < 1){
+		throw PMNError("In function PMN::countPaths():\n"
+				"The number of threads must be at least one.");
+	}
+
+	std::vector<PMConfig> &confs = configurations.back();
+	std::vector<PathCount> counts(confs.size());
+
+	if(statistics){
+		statistics->startConfigs(confs.size());
+	}
+
+	auto count = [this, &confs, &counts](std::size_t i) {
+
+		counts[i] = confs[i].countPaths();
+
+		if(statistics){
+			statistics->addPaths(counts[i].paths);
+			statistics->addSpatialPaths(counts[i].spatial_paths);
+			statistics->addWilsonStrings(counts[i].wilson_strings);
+			statistics->configDone();
+		}
+	};
+
+	if(number_of_threads == 1){
+		for(std::size_t i = 0; i < confs.size(); i++){
+			count(i);
+		}
+	}else{
+		Utility::TaskPool pool(number_of_threads);
+		Utility::TaskPool::Group group(pool);
+
+		for(std::size_t i = 0; i < confs.size(); i++){
+			group.run([&count, i]() {count(i);});
+		}
+
+		group.wait();
+	}
+
+	PathCount total;
+
+	for(const PathCount &c : counts){
+		total += c;
+	}
+
+	return total;
+}
+
+/// The streaming alternative to calling fillPaths(), print() and collect() one after the other. Every PMConfig is
+/// populated, gauge integrated, printed and collected, after which its paths are released before the next ones are
+/// filled, so that the peak memory is bounded by the largest configurations instead of the total number of paths.
+/// With more than one thread, the configurations are processed in batches of number_of_threads at a time, and
+/// every batch is printed and collected in order once it is done, so the output is the same as for the serial run.
+///
+/// To resume an interrupted run, the configurations before first_config are skipped. After every batch has been
+/// collected, configs_done (if set) is called with the number of configurations done so far, which is where
+/// checkpoints can be written.
+
+void PMN::streamPaths(Printer & printer, Collector & coll, int number_of_threads, std::size_t first_config,
+		const std::function<void(std::size_t)> & configs_done){
+
+	if(configurations.empty() or configurations.back().empty()){
+		throw PMNError("In function PMN::streamPaths():\n"
+				"Cannot fill spate-time orderings of the configurations until they have have been filled.\n"
+				"Use PMN::fillConfigs() first.");
+	}
+
+	if(number_of_threads < 1){
+		throw PMNError("In function PMN::streamPaths():\n"
+				"The number of threads must be at least one.");
+	}
+
+	std::vector<PMConfig> &confs = configurations.back();
+
+	std::unique_ptr<Utility::TaskPool> pool;
+	if(number_of_threads > 1){
+		pool.reset(new Utility::TaskPool(number_of_threads));
+	}
+
+	if(first_config > confs.size()){
+		throw PMNError("In function PMN::streamPaths():\n"
+				"Cannot resume from a configuration past the last one.");
+	}
+
+	if(first_config == 0){
+		printer.PrintPMN(*this);
+	}
+
+	if(statistics){
+		statistics->startConfigs(confs.size(), first_config);
+	}
+
+	findSymmetryImages(first_config);
+
+	for(std::size_t batch_begin = first_config; batch_begin < confs.size(); batch_begin += number_of_threads){
+
+		std::size_t batch_end = std::min(batch_begin + number_of_threads, confs.size());
+
+		populateConfigs(batch_begin, batch_end, pool.get());
+
+		for(std::size_t i = batch_begin; i < batch_end; i++){
+			{
+				RunStatistics::StageTimer timer(statistics, RunStatistics::Print);
+				confs[i].print(printer);
+			}
+			{
+				RunStatistics::StageTimer timer(statistics, RunStatistics::Collect);
+				confs[i].collect(coll);
+			}
+
+			confs[i].releasePaths();
+			releaseConfig(i);
+		}
+
+		if(statistics){
+			statistics->setCollectedTerms(coll.numberOfTerms());
+		}
+
+		if(configs_done){
+			configs_done(batch_end);
+		}
+	}
+
+	printer.PrintPMNExit(*this);
+}
+
+void PMN::collect(Collector & coll){
+
+	RunStatistics::StageTimer timer(statistics, RunStatistics::Collect);
+
+	for(PMConfig & conf : configurations.back()){
+		conf.collect(coll);
+	}
+
+	if(statistics){
+		statistics->setCollectedTerms(coll.numberOfTerms());
+	}
+}
+
+void PMN::print(Printer & printer) const{
+
+	RunStatistics::StageTimer timer(statistics, RunStatistics::Print);
+
+	printer.PrintPMN(*this);
+
+	for(const PMConfig & conf : configurations.back()){
+		conf.print(printer);
 	}
 
+	printer.PrintPMNExit(*this);
 }
 
 /// This function uses the fact that the WilsonString < WilsonString operator gives a strict enough ordering 
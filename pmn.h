@@ -11,6 +11,7 @@
 #include<vector>
 #include<set>
 #include<memory>
+#include<functional>
 
 #include<cinttypes>
 
@@ -30,6 +31,8 @@ namespace hop{
 
 using boost::math::gcd;
 
+class RunStatistics;
+
 struct WilsonStringPtr{
 	const WilsonString *ptr;
 	boost::rational<PM::pref_type> prefactor;
@@ -37,6 +40,53 @@ struct WilsonStringPtr{
 	~WilsonStringPtr();
 };
 
+//// Generator which yields the multi-trace configurations of a given order one at a time, built from the single-trace
+//// configurations of the lower orders. A multi-trace configuration is a product of single-trace configurations whose
+//// orders sum up to the given order, e.g. at order 8: pm.pm.pm.pm, pm.pm.ppmm, ppmm.pmpm and so on. The factors are
+//// kept as indices into the lower order configurations, so nothing is built until config() is called. The generator
+//// follows the iterator style of Utility::Permutation::Lexicographic, with !gen being true while there are more
+//// configurations to come.
+
+class MultiTraceGenerator{
+private:
+	const std::vector< std::vector<PMConfig> > &configurations;
+	int order;
+
+	std::list< std::vector<int> > combinations; //which orders to combine, e.g. {2,2,4} for pm.pm.ppmm
+	std::list< std::vector<int> >::const_iterator current_comb;
+
+	std::vector<int> indices; //which configuration of each order is used for each factor
+
+	const std::vector<PMConfig>& configs_of_order(int kappa) const {return configurations[kappa/2 - 1];};
+	int first_index(int factor) const;
+	void reset_indices_from(int factor);
+
+public:
+	MultiTraceGenerator(const std::vector< std::vector<PMConfig> > &configurations, int order);
+
+	void operator++();
+
+	bool operator!() const {return current_comb != combinations.end();};
+	operator bool() const {return current_comb == combinations.end();};
+
+	std::size_t numberOfFactors() const {return indices.size();};
+	const PMConfig& factor(std::size_t i) const {return configs_of_order((*current_comb)[i])[indices[i]];};
+
+	PM::pref_type denominator() const;
+	PMConfig config() const;
+};
+
+//// The symmetry partner of a configuration under p <-> m, reversal or both (together with rotations). If image is
+//// not negative, position i of the configuration corresponds to position position_map[i] of the configuration with
+//// index image, which is the representative of their orbit.
+
+struct SymmetryImage{
+	std::ptrdiff_t image;
+	std::vector<int> position_map;
+
+	SymmetryImage() : image(-1) {};
+};
+
 //// Class which saves all unique pmConfigurations to all orders up to "order", or only the highest order if 
 //// allOrders = false. It also has a list of PMComb's, which is all multi-trace configurations at the highest
 //// order. This list can only be filled if allOrders = true, as it needs the results from the lower order
@@ -52,45 +102,52 @@ private:
 
 	int order;
 
+	RunStatistics *statistics;
+
+	//The symmetry reduction of the temporal paths, see pmn.symmetry.cpp
+	bool symmetry_reduction;
+	std::vector<SymmetryImage> symmetry_images;
+	std::vector< std::list< std::vector<int> > > image_links;
+	std::vector<int> partners_left;
+
+	void findSymmetryImages(std::size_t first_config);
+	void releaseConfig(std::size_t i);
+
+	void populateConfigs(std::size_t begin, std::size_t end, Utility::TaskPool *pool);
+
 public:
 	PMN(int);
 
 	//Functions related to the filling of the single-trace configurations
 	void fillConfigs();
-	void fillPaths();
+	void fillPaths(int number_of_threads = 1);
+	void streamPaths(Printer & printer, Collector & coll, int number_of_threads = 1, std::size_t first_config = 0,
+			const std::function<void(std::size_t)> & configs_done = nullptr);
+
+	std::size_t numberOfConfigs() const {return configurations.back().size();};
+
+	PathCount countPaths(int number_of_threads = 1);
+
+	void selectShard(int shard_index, int shard_count);
+
+	void reduceSymmetries(bool reduce = true) {symmetry_reduction = reduce;};
+
+	//The statistics are updated during the run if set, see run_statistics.hpp
+	void setStatistics(RunStatistics *stats) {statistics = stats;};
 
 	//Functions related to the alternative printing
 	void fillTermsList();
 	void contractWilsons();
 	void printWilsonTerms(FILE *out=stdout, bool printCheck = true) const;
 
-	void collect(Collector & coll)
-	{
-		for(PMConfig & conf : configurations.back())
-			conf.collect(coll);
-	};
-
-  void print(Printer & printer) const
-  {
-    printer.PrintPMN(*this);
-
-    for(const PMConfig & conf : configurations.back())
-      conf.print(printer);
-
-    printer.PrintPMNExit(*this);
-  };
+	void collect(Collector & coll);
+	void print(Printer & printer) const;
 
 	//Contains an integer i and how many times it has been counted
 	struct intCount{
 		int i;
 		int c;
 	};
-
-private:
-
-	//Function which fills up configurations and multiTrConf
-	int fillAllConfigs(int,int,int,std::vector<PMConfig>&,int);
-	void fill_multi_config(const std::vector<int>&,int,int,std::list< std::vector<int> >);
 };
 
 class PMNError : public Error {
@@ -0,0 +1,138 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 17:12:40 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+//Description: The symmetry reduction of the temporal paths of the PMN class
+
+#include"pmn.h"
+
+#include<map>
+
+namespace hop{
+
+/* ============================================================================================================================
+ * Small anonymous helper functions to be used by the following member functions
+ * ============================================================================================================================ */
+
+namespace{
+
+/// Finds the rotation which makes the configuration lexicographically largest, which with Cfg_P > Cfg_M is the
+/// p...m form the configurations are generated on. Returns the offset r, so that the rotated configuration is
+/// cfg[(i + r) % len].
+
+int canonical_rotation(const std::vector<Config> &cfg){
+
+  int len = cfg.size();
+  int best = 0;
+
+  for(int r=1; r<len; r++){
+    for(int i=0; i<len; i++){
+      Config lhs = cfg[(i + r) % len], rhs = cfg[(i + best) % len];
+
+      if(lhs != rhs){
+        if(lhs > rhs){
+          best = r;
+        }
+        break;
+      }
+    }
+  }
+
+  return best;
+}
+
+std::vector<Config> rotated(const std::vector<Config> &cfg, int r){
+
+  std::vector<Config> result(cfg.size());
+
+  for(int i=0; i<cfg.size(); i++){
+    result[i] = cfg[(i + r) % cfg.size()];
+  }
+
+  return result;
+}
+
+}; //Anonymous namespace
+
+/// Finds the symmetry partners among the configurations from first_config onwards. Swapping p and m, reversing the
+/// configuration, or both, maps a single trace configuration onto another one (up to a rotation), whose temporal
+/// links are the same up to a relabelling of the positions. The first configuration of every orbit is its
+/// representative, which runs the temporal recursion, while the others are populated from its links. E.g. at order 6
+/// ppmmpm is found from ppmpmm by swapping p and m.
+///
+/// Only the temporal links are shared. The spatial paths and the gauge integrals are still done for every
+/// configuration, as the WilsonStrings of two partners are in general different terms. The multi-trace
+/// configurations are always their own representatives.
+
+void PMN::findSymmetryImages(std::size_t first_config){
+
+  std::vector<PMConfig> &confs = configurations.back();
+
+  symmetry_images.assign(confs.size(), SymmetryImage());
+  image_links.assign(confs.size(), std::list< std::vector<int> >());
+  partners_left.assign(confs.size(), 0);
+
+  if(!symmetry_reduction){
+    return;
+  }
+
+  //The representatives, on their canonical rotation, with their index and the rotation
+  std::map< std::vector<Config>, std::pair<std::size_t,int> > representatives;
+
+  for(std::size_t i = first_config; i < confs.size(); i++){
+
+    if(!confs[i].is_single()){
+      continue;
+    }
+
+    const std::vector<Config> &cfg = confs[i].cfgArray;
+    int len = cfg.size();
+
+    //The transformations swap (1), reverse (2) or both (3). Transformed position k comes from position source[k]
+    for(int transformation = 1; transformation <= 3; transformation++){
+
+      std::vector<Config> transformed(len);
+      std::vector<int> source(len);
+
+      for(int k=0; k<len; k++){
+        source[k] = (transformation & 2) ? (len - 1 - k) : k;
+        transformed[k] = (transformation & 1) ? static_cast<Config>(-cfg[source[k]]) : cfg[source[k]];
+      }
+
+      int r = canonical_rotation(transformed);
+      auto rep = representatives.find(rotated(transformed, r));
+
+      if(rep == representatives.end()){
+        continue;
+      }
+
+      symmetry_images[i].image = rep->second.first;
+      symmetry_images[i].position_map.resize(len);
+
+      for(int k=0; k<len; k++){
+        symmetry_images[i].position_map[source[(k + r) % len]] = (k + rep->second.second) % len;
+      }
+
+      partners_left[rep->second.first]++;
+      break;
+    }
+
+    if(symmetry_images[i].image < 0){
+      int r = canonical_rotation(cfg);
+      representatives.emplace(rotated(cfg, r), std::make_pair(i, r));
+    }
+  }
+}
+
+/// Called once a configuration is done, which releases the temporal links of its representative once the last of
+/// the partners is populated.
+
+void PMN::releaseConfig(std::size_t i){
+
+  std::ptrdiff_t image = symmetry_images[i].image;
+
+  if(image >= 0 and --partners_left[image] == 0){
+    image_links[image].clear();
+  }
+}
+
+}; //Namespace hop
@@ -0,0 +1,144 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 18:02:13 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#include"run_statistics.hpp"
+
+#include<iomanip>
+#include<sstream>
+
+#include<boost/property_tree/ptree.hpp>
+#include<boost/property_tree/json_parser.hpp>
+
+namespace hop {
+
+const char * RunStatistics::stage_names[RunStatistics::NumberOfStages] = {
+  "fill_configs",
+  "temporal_paths",
+  "spatial_paths",
+  "gauge_integrate",
+  "print",
+  "collect",
+  "term_output"
+};
+
+namespace {
+
+double seconds(RunStatistics::clock::duration duration)
+{
+  return std::chrono::duration<double>(duration).count();
+}
+
+std::string format_seconds(double x)
+{
+  std::ostringstream oss;
+  oss << std::fixed << std::setprecision(6) << x;
+  return oss.str();
+}
+
+}; //Anonymous namespace
+
+RunStatistics::RunStatistics(int order, int number_of_threads, std::ostream & progress_out, int progress_interval)
+  : order(order), number_of_threads(number_of_threads),
+    progress_out(progress_out), progress_interval(progress_interval),
+    run_start(clock::now()), last_report(run_start),
+    configs_done(0), configs_skipped(0), number_of_configs(0),
+    paths(0), spatial_paths(0), wilson_strings(0), collected_terms(0)
+{
+  for(int i = 0; i < NumberOfStages; ++i) {
+    stage_time[i] = 0;
+    stage_calls[i] = 0;
+  }
+}
+
+void RunStatistics::addTime(Stage stage, clock::duration duration)
+{
+  stage_time[stage] += std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  ++stage_calls[stage];
+}
+
+void RunStatistics::startConfigs(std::uint64_t n, std::uint64_t skipped)
+{
+  number_of_configs = n;
+  configs_skipped = skipped;
+  configs_done = skipped;
+}
+
+/// Counts a finished configuration, and writes a progress line if it is time for it. A thread which finds another
+/// one already reporting just moves on.
+
+void RunStatistics::configDone()
+{
+  ++configs_done;
+
+  if(progress_interval <= 0)
+    return;
+
+  std::unique_lock<std::mutex> lock(report_mutex, std::try_to_lock);
+
+  if(lock.owns_lock() and clock::now() - last_report >= std::chrono::seconds(progress_interval))
+    report(false);
+}
+
+/// The rate and remaining time are estimated from the configurations done by this run only. The configurations
+/// differ a lot in size, so the estimate is rough, but it tells a slow run from a hanging one.
+
+void RunStatistics::report(bool final_report)
+{
+  auto now = clock::now();
+  last_report = now;
+
+  double elapsed = seconds(now - run_start);
+  std::uint64_t done = configs_done;
+  std::uint64_t done_here = done - configs_skipped;
+
+  double rate = (elapsed > 0) ? done_here/elapsed : 0;
+
+  progress_out << (final_report ? "[done] " : "[progress] ")
+               << "configs " << done << "/" << number_of_configs
+               << " paths " << paths << " spatial " << spatial_paths
+               << " wilson " << wilson_strings << " terms " << collected_terms
+               << std::fixed << std::setprecision(1)
+               << " elapsed " << elapsed << "s"
+               << " rate " << std::setprecision(2) << rate << " configs/s";
+
+  if(!final_report and done_here > 0)
+    progress_out << " eta " << std::setprecision(0) << (number_of_configs - done)/rate << "s";
+
+  progress_out << std::defaultfloat << std::endl;
+}
+
+/// Writes the counters and the time spent in every stage as a JSON file. The stages are written in the order they
+/// are run, each with the accumulated time in seconds and the number of times it was timed.
+
+void RunStatistics::WriteToFile(const std::string & filename) const
+{
+  boost::property_tree::ptree tree;
+
+  tree.put("order", order);
+  tree.put("threads", number_of_threads);
+  tree.put("wall_seconds", format_seconds(seconds(clock::now() - run_start)));
+
+  tree.put("counters.configs_done", configs_done.load());
+  tree.put("counters.configs_total", number_of_configs);
+  tree.put("counters.paths", paths.load());
+  tree.put("counters.spatial_paths", spatial_paths.load());
+  tree.put("counters.wilson_strings", wilson_strings.load());
+  tree.put("counters.collected_terms", collected_terms.load());
+
+  boost::property_tree::ptree stages;
+
+  for(int i = 0; i < NumberOfStages; ++i) {
+    boost::property_tree::ptree stage;
+    stage.put("seconds", format_seconds(stage_time[i]*1e-9));
+    stage.put("calls", stage_calls[i].load());
+
+    stages.push_back( std::make_pair(stage_names[i], stage) );
+  }
+
+  tree.add_child("stages", stages);
+
+  boost::property_tree::write_json(filename, tree);
+}
+
+} //Namespace hop
@@ -0,0 +1,111 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 18:02:13 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#ifndef RUN_STATISTICS_HPP
+#define RUN_STATISTICS_HPP
+
+#include<iostream>
+#include<string>
+#include<array>
+#include<atomic>
+#include<mutex>
+#include<chrono>
+#include<cstdint>
+
+namespace hop {
+
+//// Counters and timers of the different stages of a PMN run. The time of every stage is accumulated over all
+//// threads, so with more than one thread the stages add up to more than the wall time. The counters and timers
+//// are atomic, so the statistics can be updated from the tasks of a TaskPool.
+////
+//// Every time a configuration is done a progress line with the throughput and an estimate of the remaining time is
+//// written, at most once every progress_interval seconds (never if it is zero). The final breakdown is written as
+//// JSON by WriteToFile().
+
+class RunStatistics
+{
+public:
+  enum Stage
+  {
+    FillConfigs,
+    TemporalPaths,
+    SpatialPaths,
+    GaugeIntegrate,
+    Print,
+    Collect,
+    TermOutput,
+    NumberOfStages
+  };
+
+  typedef std::chrono::steady_clock clock;
+
+  //// Adds the time from construction to destruction to a stage, does nothing if statistics is a nullptr
+  class StageTimer
+  {
+  private:
+    RunStatistics * statistics;
+    Stage stage;
+    clock::time_point start;
+
+  public:
+    StageTimer(RunStatistics * statistics, Stage stage)
+      : statistics(statistics), stage(stage), start(clock::now()) {};
+
+    ~StageTimer()
+    {
+      if(statistics)
+        statistics->addTime(stage, clock::now() - start);
+    };
+  };
+
+private:
+  int order;
+  int number_of_threads;
+
+  std::ostream & progress_out;
+  int progress_interval;
+
+  clock::time_point run_start;
+  clock::time_point last_report;
+  std::mutex report_mutex;
+
+  std::array<std::atomic<std::int64_t>, NumberOfStages> stage_time;
+  std::array<std::atomic<std::uint64_t>, NumberOfStages> stage_calls;
+
+  std::atomic<std::uint64_t> configs_done;
+  std::uint64_t configs_skipped;
+  std::uint64_t number_of_configs;
+
+  std::atomic<std::uint64_t> paths;
+  std::atomic<std::uint64_t> spatial_paths;
+  std::atomic<std::uint64_t> wilson_strings;
+  std::atomic<std::uint64_t> collected_terms;
+
+  static const char * stage_names[NumberOfStages];
+
+  void report(bool final_report);
+
+public:
+  RunStatistics(int order, int number_of_threads, std::ostream & progress_out = std::cerr, int progress_interval = 0);
+
+  void addTime(Stage stage, clock::duration duration);
+
+  //// The number of configurations to do, of which the first skipped ones are already done (when resuming)
+  void startConfigs(std::uint64_t number_of_configs, std::uint64_t skipped = 0);
+  void configDone();
+
+  void addPaths(std::uint64_t n) {paths += n;};
+  void addSpatialPaths(std::uint64_t n) {spatial_paths += n;};
+  void addWilsonStrings(std::uint64_t n) {wilson_strings += n;};
+  void setCollectedTerms(std::uint64_t n) {collected_terms = n;};
+
+  //// Writes a final progress line
+  void finish() {report(true);};
+
+  void WriteToFile(const std::string & filename) const;
+};
+
+} //Namespace hop
+
+#endif /* RUN_STATISTICS_HPP */
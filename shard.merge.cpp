@@ -0,0 +1,81 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 15:58:47 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+//Description: Combines the partial results of a sharded run (main.out --shard i/N) into the final .terms and .json files
+#include<cstdio>
+#include<iostream>
+
+#include<vector>
+#include<list>
+#include<string>
+using namespace std;
+
+#include<boost/lexical_cast.hpp>
+
+#include"collector.concrete.hpp"
+#include"checkpoint.hpp"
+#include"term_output.hpp"
+
+int main(int argc, char** argv)
+{
+
+  if(argc < 2) {
+    cerr << "Usage: " << argv[0] << " SHARD.part [SHARD.part ...]" << endl;
+    return 1;
+  }
+
+  hop::TermCollector collector;
+  hop::Checkpoint first;
+
+  vector<char> shard_seen;
+
+  for(int i = 1; i < argc; ++i) {
+
+    hop::Checkpoint shard;
+    list<hop::WilsonString> terms;
+
+    try{
+      shard.Load(argv[i], terms);
+    }catch (hop::CheckpointError &err) {
+      cerr << "While reading \"" << argv[i] << "\":" << endl << err << endl;
+      return 1;
+    }
+
+    if(!shard.is_complete()) {
+      cerr << "The shard \"" << argv[i] << "\" is unfinished (" << shard.configs_done
+           << " of " << shard.number_of_configs << " configurations done)" << endl;
+      return 1;
+    }
+
+    if(i == 1) {
+      first = shard;
+      shard_seen.assign(shard.shard_count, false);
+    } else if(shard.order != first.order or shard.shard_count != first.shard_count) {
+      cerr << "The shard \"" << argv[i] << "\" does not belong to the same run as \"" << argv[1] << "\"" << endl;
+      return 1;
+    }
+
+    if(shard_seen[shard.shard_index]) {
+      cerr << "Shard " << shard.shard_index << " is given more than once" << endl;
+      return 1;
+    }
+
+    shard_seen[shard.shard_index] = true;
+    collector.mergeResults(terms);
+  }
+
+  for(int i = 0; i < first.shard_count; ++i) {
+    if(!shard_seen[i]) {
+      cerr << "Shard " << i << " of " << first.shard_count << " is missing" << endl;
+      return 1;
+    }
+  }
+
+  string foldername = "Configurations";
+  hop::MakeOutputFolder(foldername);
+
+  list<hop::WilsonString> terms;
+  collector.fetchResults(terms);
+
+  hop::PrintTermFiles(foldername + "/kappa" + boost::lexical_cast<string>(first.order), terms);
+}
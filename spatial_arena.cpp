@@ -0,0 +1,95 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 19:10:42 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#include"spatial_arena.hpp"
+
+#include<limits>
+
+#include"std_libs/error.h"
+
+namespace hop {
+
+namespace {
+
+std::int8_t narrow(int x)
+{
+  if(x < std::numeric_limits<std::int8_t>::min() or x > std::numeric_limits<std::int8_t>::max())
+    throw Error("A spatial path or displacement does not fit in the arena","spatial_arena");
+
+  return static_cast<std::int8_t>(x);
+}
+
+}; //Anonymous namespace
+
+void SpatialArena::assign(const std::list< std::vector<int> > & s_paths,
+                          const std::list< std::vector<Position::pos> > & trace_disp, int dim)
+{
+  clear();
+
+  if(s_paths.empty())
+    return;
+
+  path_length = s_paths.front().size();
+  number_of_traces = trace_disp.empty() ? 0 : trace_disp.front().size();
+  dimension = dim;
+
+  if(number_of_traces > 0 and trace_disp.size() != s_paths.size())
+    throw Error("The spatial paths and the trace displacements are out of sync","spatial_arena");
+
+  std::size_t entry_size = path_length + number_of_traces*dimension;
+
+  data.reserve(entry_size*s_paths.size());
+  offsets.reserve(s_paths.size());
+
+  auto disp_it = trace_disp.begin();
+
+  for(const std::vector<int> & s_path : s_paths) {
+
+    offsets.push_back(data.size());
+
+    for(int x : s_path)
+      data.push_back(narrow(x));
+
+    if(number_of_traces == 0)
+      continue;
+
+    for(const Position::pos & disp : *disp_it)
+      for(int i = 0; i < dimension; ++i)
+        data.push_back(narrow(disp.at(i)));
+
+    ++disp_it;
+  }
+}
+
+void SpatialArena::clear()
+{
+  data.clear();
+  offsets.clear();
+  path_length = number_of_traces = dimension = 0;
+}
+
+std::vector<int> SpatialArena::spatialPathVector(std::size_t k) const
+{
+  const std::int8_t * s_path = spatialPath(k);
+  return std::vector<int>(s_path, s_path + path_length);
+}
+
+std::vector<Position::pos> SpatialArena::displacements(std::size_t k) const
+{
+  std::vector<Position::pos> result;
+  result.reserve(number_of_traces);
+
+  const std::int8_t * disp = spatialPath(k) + path_length;
+
+  for(int t = 0; t < number_of_traces; ++t) {
+    result.emplace_back(dimension);
+
+    for(int i = 0; i < dimension; ++i)
+      result.back().at(i) = *disp++;
+  }
+
+  return result;
+}
+
+} //Namespace hop
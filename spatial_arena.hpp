@@ -0,0 +1,56 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 19:10:42 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#ifndef SPATIAL_ARENA_HPP
+#define SPATIAL_ARENA_HPP
+
+#include<vector>
+#include<list>
+#include<cstdint>
+
+#include"std_libs/position/position_class.hpp"
+
+namespace hop {
+
+//// Compact storage of the final spatial paths of a PMPath together with their trace displacements. While they are
+//// built the spatial paths are kept in lists, as paths are split, erased and appended all the time, but once they
+//// are done they are only read, by the gauge integral and the printers. The arena stores everything in a single
+//// byte array: entry k is spatial path k (one signed byte per link point) followed by its trace displacements (one
+//// byte per component, for every trace), starting at offsets[k]. The link labels and the components are bounded by
+//// the length of the path, which is checked when the arena is filled.
+
+class SpatialArena
+{
+private:
+  std::vector<std::int8_t> data;
+  std::vector<std::uint32_t> offsets;
+
+  std::uint16_t path_length;
+  std::uint16_t number_of_traces;
+  std::uint16_t dimension;
+
+public:
+  SpatialArena() : path_length(0), number_of_traces(0), dimension(0) {};
+
+  //// Packs the spatial paths and their trace displacements, which have to be in the same order. Single trace paths
+  //// have no displacements.
+  void assign(const std::list< std::vector<int> > & s_paths,
+              const std::list< std::vector<Position::pos> > & trace_disp, int dimension);
+
+  void clear();
+
+  std::size_t size() const {return offsets.size();};
+  bool empty() const {return offsets.empty();};
+
+  bool hasDisplacements() const {return number_of_traces > 0;};
+
+  const std::int8_t * spatialPath(std::size_t k) const {return data.data() + offsets[k];};
+
+  std::vector<int> spatialPathVector(std::size_t k) const;
+  std::vector<Position::pos> displacements(std::size_t k) const;
+};
+
+} //Namespace hop
+
+#endif /* SPATIAL_ARENA_HPP */
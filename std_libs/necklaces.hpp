@@ -0,0 +1,108 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 10:12:40 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#ifndef NECKLACES_HPP
+#define NECKLACES_HPP
+
+#include"typedefs.hpp"
+
+#include<list>
+#include<vector>
+
+#include<exception>
+#include<stdexcept>
+
+/// Generates all binary necklaces of a fixed length and a fixed number of ones (the density). A necklace is the
+/// lexicographically smallest representative of a class of strings which are equal up to rotation, so every
+/// necklace starts with a 0 and ends with a 1 (unless the density is 0 or the full length). The generation uses
+/// the Fredricksen-Kessler-Maiorana recursion over pre-necklaces, where branches are cut as soon as they would
+/// contain too many zeros or ones. The necklaces are returned in lexicographic order, each accompanied by the
+/// number of distinct strings in its rotation class (its period).
+
+template <
+  class IntegerType = int,
+  typename = EnableIf< std::is_integral<IntegerType> > >
+class FixedDensityNecklaces
+{
+public:
+	struct Necklace
+	{
+		std::vector<int> word;
+		IntegerType multiplicity;
+	};
+
+private:
+	int length;
+	int density;
+
+	std::vector<int> currentWord; //1-indexed, currentWord[0] is a sentinel zero
+	int numberOfOnes;
+
+private:
+
+	void addNecklaceToResult(std::list<Necklace> &result, int period) {
+		result.push_back({ std::vector<int>(currentWord.begin()+1, currentWord.end()), period });
+	};
+
+	bool canPlace(int t, int symbol) const {
+		if(symbol == 1)
+			return numberOfOnes < density;
+		else
+			return (t - 1 - numberOfOnes) < (length - density);
+	};
+
+	void placeSymbol(std::list<Necklace> &result, int t, int period, int symbol) {
+
+		if(!canPlace(t, symbol))
+			return;
+
+		currentWord[t] = symbol;
+		numberOfOnes += symbol;
+		extendPreNecklace(result, t+1, period);
+		numberOfOnes -= symbol;
+	};
+
+	void extendPreNecklace(std::list<Necklace> &result, int t, int period) {
+
+		//A complete pre-necklace is a necklace only if its period divides the length
+		if(t > length){
+			if(length % period == 0)
+				addNecklaceToResult(result, period);
+			return;
+		}
+
+		int repeated = currentWord[t-period];
+
+		placeSymbol(result, t, period, repeated);
+
+		if(repeated == 0)
+			placeSymbol(result, t, t, 1);
+	};
+
+public:
+	std::list<Necklace> calculate() {
+		std::list<Necklace> result;
+
+		if(length == 0)
+			return result;
+
+		numberOfOnes = 0;
+		currentWord.assign(length + 1, 0);
+		extendPreNecklace(result, 1, 1);
+
+		return result;
+	};
+
+	FixedDensityNecklaces(int length, int density) :
+		length(length), density(density), numberOfOnes(0)
+	{
+		if( (length < 0) or (density < 0) or (density > length) ) {
+			throw std::invalid_argument("In construction of FixedDensityNecklaces-class: The density must lie between 0 and the length.");
+		}
+	};
+
+	virtual ~FixedDensityNecklaces() {};
+};
+
+#endif /* NECKLACES_HPP */
@@ -1,11 +1,10 @@
 //Created: 10-02-2014
-//Modified: Wed 25 Feb 2015 11:47:28 CET
+//Modified: Sat 17 Oct 2026 23:10:27 CEST
 //Author: Jonas R. Glesaaen (jonas@glesaaen.com)
 
 #ifndef POSITION_CLASS_H
 #define POSITION_CLASS_H
 
-#include<deque>
 #include<initializer_list>
 
 #include<algorithm>
@@ -17,6 +16,9 @@
 #include"../std_funcs.h"
 #include"../error.h"
 
+#include"position_storage.hpp"
+#include"position_kernels.hpp"
+
 namespace Position {
 
 namespace Manipulator {
@@ -28,19 +30,24 @@ class pos
 friend class Manipulator::CoordinateCleaner;
 friend class Parser;
 
+public:
+  //The components are kept inline up to this many dimensions
+  static const std::size_t inline_dimensions = 16;
+  typedef InlineStorage<int, inline_dimensions> storage_type;
+
 private:
-	std::deque<int> pos_vec;
+	storage_type pos_vec;
 
 public:
 
   typedef int value_type;
-  typedef std::deque<int>::size_type size_type;
+  typedef storage_type::size_type size_type;
   typedef int& reference;
   typedef int* pointer;
   typedef const int& const_reference;
   typedef const int* const_pointer;
-  typedef std::deque<int>::iterator iterator;
-  typedef std::deque<int>::const_iterator const_iterator;
+  typedef storage_type::iterator iterator;
+  typedef storage_type::const_iterator const_iterator;
 
 	pos() {};
 	pos(size_type l) : pos_vec(l,0) {};
@@ -151,40 +158,24 @@ public:
 
 	pos& operator+= (const pos &rhs)
 	{
-		int llen = pos_vec.size(), rlen = rhs.pos_vec.size();
+		size_type rlen = rhs.pos_vec.size();
 
-		if(llen < rlen) {
+		if(pos_vec.size() < rlen)
+			pos_vec.resize(rlen, 0);
 
-			for(int i = 0; i < llen; ++i)
-				pos_vec[i] += rhs.pos_vec[i];
-
-			for(int i = llen; i < rlen; ++i)
-				pos_vec.push_back(rhs.pos_vec[i]);
-		} else {
-			
-			for(int i = 0; i < rlen; ++i)
-				pos_vec[i] += rhs.pos_vec[i];
-		}
+		Kernel::add(pos_vec.begin(), rhs.pos_vec.begin(), rlen);
 
 		return *this;
 	};
 
 	pos& operator-= (const pos &rhs)
 	{
-		int llen = pos_vec.size(), rlen = rhs.pos_vec.size();
-
-		if(llen < rlen) {
+		size_type rlen = rhs.pos_vec.size();
 
-			for(int i = 0; i < llen; ++i)
-				pos_vec[i] -= rhs.pos_vec[i];
+		if(pos_vec.size() < rlen)
+			pos_vec.resize(rlen, 0);
 
-			for(int i = llen; i < rlen; ++i)
-				pos_vec.push_back(-rhs.pos_vec[i]);
-		} else {
-			
-			for(int i = 0; i < rlen; ++i)
-				pos_vec[i] -= rhs.pos_vec[i];
-		}
+		Kernel::subtract(pos_vec.begin(), rhs.pos_vec.begin(), rlen);
 
 		return *this;
 	};
@@ -201,27 +192,14 @@ public:
 
 	bool operator==(const pos &v) const 
 	{ 
-		const std::deque<int> *long_vec, *short_vec;
+		const storage_type &long_vec = (pos_vec.size() < v.pos_vec.size()) ? v.pos_vec : pos_vec;
+		size_type common = std::min(pos_vec.size(), v.pos_vec.size());
+		size_type tail = long_vec.size() - common;
 
-		if(pos_vec.size() < v.pos_vec.size()) {
-			short_vec = &pos_vec;
-			long_vec = &v.pos_vec;
-		} else {
-			short_vec = &v.pos_vec;
-			long_vec = &pos_vec;
-		}
-
-		for(int i = 0; i < short_vec->size(); ++i) {
-			if( (*short_vec)[i] != (*long_vec)[i] )
-				return false;
-		}
-
-		for(int i = short_vec->size(); i < long_vec->size(); ++i) {
-			if( (*long_vec)[i] != 0 )
-				return false;
-		}
+		if(Kernel::mismatch(pos_vec.begin(), v.pos_vec.begin(), common) != common)
+			return false;
 
-		return true;
+		return Kernel::first_non_zero(long_vec.begin() + common, tail) == tail;
 	};
 
 	bool operator!=(const pos &v) const 
@@ -231,28 +209,25 @@ public:
 
 	bool operator<(const pos &v) const
 	{
-		int llen = pos_vec.size(), rlen = v.pos_vec.size();
+		size_type llen = pos_vec.size(), rlen = v.pos_vec.size();
+		size_type common = std::min(llen, rlen);
+
+		size_type i = Kernel::mismatch(pos_vec.begin(), v.pos_vec.begin(), common);
+
+		if(i < common)
+			return (pos_vec[i] < v.pos_vec[i]);
 
+		//Past the common part, the shorter position is compared as if padded by zeros
 		if(llen < rlen) {
-			for(int i = 0; i < llen; ++i) {
-				if(pos_vec[i] != v.pos_vec[i]) 
-					return (pos_vec[i] < v.pos_vec[i]);
-			}
-
-			for(int i = llen; i < rlen; ++i) {
-				if(0 != v.pos_vec[i]) 
-					return ( 0 < v.pos_vec[i]);
-			}
+			i = common + Kernel::first_non_zero(v.pos_vec.begin() + common, rlen - common);
+
+			if(i < rlen)
+				return ( 0 < v.pos_vec[i]);
 		} else {
-			for(int i = 0; i < rlen; ++i) {
-				if(pos_vec[i] != v.pos_vec[i]) 
-					return (pos_vec[i] < v.pos_vec[i]);
-			}
-
-			for(int i = rlen; i < llen; ++i) {
-				if(0 != pos_vec[i]) 
-					return ( pos_vec[i] < 0 );
-			}
+			i = common + Kernel::first_non_zero(pos_vec.begin() + common, llen - common);
+
+			if(i < llen)
+				return ( pos_vec[i] < 0 );
 		}
 		
 		return false;
@@ -262,10 +237,7 @@ public:
 
 	bool is_zero() const 
 	{ 
-		return std::all_of(pos_vec.begin(), pos_vec.end(), 
-				[](int x){
-					return x == 0;
-				}); 
+		return Kernel::first_non_zero(pos_vec.begin(), pos_vec.size()) == pos_vec.size();
 	};
 
   bool is_empty() const
@@ -0,0 +1,134 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 23:02:51 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#ifndef POSITION_KERNELS_HPP
+#define POSITION_KERNELS_HPP
+
+#include<cstddef>
+
+#ifdef __SSE2__
+#include<emmintrin.h>
+#endif
+
+namespace Position {
+
+//// The loops over the components of two positions used by the pos operators. They work on the common part of two
+//// component arrays, the pos class takes care of the parts where the lengths differ. When SSE2 is available the
+//// components are handled four at a time, with the remainder (and every component without SSE2) done by the scalar
+//// versions, which are also what the vectorised ones are tested against.
+
+namespace Kernel {
+
+namespace Scalar {
+
+inline void add(int *lhs, const int *rhs, std::size_t len)
+{
+  for(std::size_t i = 0; i < len; ++i)
+    lhs[i] += rhs[i];
+}
+
+inline void subtract(int *lhs, const int *rhs, std::size_t len)
+{
+  for(std::size_t i = 0; i < len; ++i)
+    lhs[i] -= rhs[i];
+}
+
+/// The index of the first component where the two arrays differ, or len if they are equal
+inline std::size_t mismatch(const int *lhs, const int *rhs, std::size_t len)
+{
+  std::size_t i = 0;
+
+  while(i < len and lhs[i] == rhs[i])
+    ++i;
+
+  return i;
+}
+
+/// The index of the first non-zero component, or len if all are zero
+inline std::size_t first_non_zero(const int *x, std::size_t len)
+{
+  std::size_t i = 0;
+
+  while(i < len and x[i] == 0)
+    ++i;
+
+  return i;
+}
+
+} //Namespace Scalar
+
+#ifdef __SSE2__
+
+namespace Vector {
+
+static const std::size_t width = 4;
+
+inline __m128i load(const int *x) {return _mm_loadu_si128(reinterpret_cast<const __m128i*>(x));}
+inline void store(int *x, __m128i v) {_mm_storeu_si128(reinterpret_cast<__m128i*>(x), v);}
+
+inline void add(int *lhs, const int *rhs, std::size_t len)
+{
+  std::size_t i = 0;
+
+  for(; i + width <= len; i += width)
+    store(lhs + i, _mm_add_epi32(load(lhs + i), load(rhs + i)));
+
+  Scalar::add(lhs + i, rhs + i, len - i);
+}
+
+inline void subtract(int *lhs, const int *rhs, std::size_t len)
+{
+  std::size_t i = 0;
+
+  for(; i + width <= len; i += width)
+    store(lhs + i, _mm_sub_epi32(load(lhs + i), load(rhs + i)));
+
+  Scalar::subtract(lhs + i, rhs + i, len - i);
+}
+
+inline std::size_t mismatch(const int *lhs, const int *rhs, std::size_t len)
+{
+  std::size_t i = 0;
+
+  for(; i + width <= len; i += width) {
+    if(_mm_movemask_epi8(_mm_cmpeq_epi32(load(lhs + i), load(rhs + i))) != 0xFFFF)
+      break;
+  }
+
+  return i + Scalar::mismatch(lhs + i, rhs + i, len - i);
+}
+
+inline std::size_t first_non_zero(const int *x, std::size_t len)
+{
+  std::size_t i = 0;
+  const __m128i zero = _mm_setzero_si128();
+
+  for(; i + width <= len; i += width) {
+    if(_mm_movemask_epi8(_mm_cmpeq_epi32(load(x + i), zero)) != 0xFFFF)
+      break;
+  }
+
+  return i + Scalar::first_non_zero(x + i, len - i);
+}
+
+} //Namespace Vector
+
+using Vector::add;
+using Vector::subtract;
+using Vector::mismatch;
+using Vector::first_non_zero;
+
+#else
+
+using Scalar::add;
+using Scalar::subtract;
+using Scalar::mismatch;
+using Scalar::first_non_zero;
+
+#endif /* __SSE2__ */
+
+} //Namespace Kernel
+} //Namespace Position
+
+#endif /* POSITION_KERNELS_HPP */
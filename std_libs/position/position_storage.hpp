@@ -0,0 +1,216 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 22:31:04 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#ifndef POSITION_STORAGE_HPP
+#define POSITION_STORAGE_HPP
+
+#include<cstddef>
+#include<array>
+#include<memory>
+#include<iterator>
+#include<algorithm>
+#include<initializer_list>
+#include<type_traits>
+
+#include<stdexcept>
+
+namespace Position {
+
+//// The storage of the components of a pos. The first N components are kept inline in the object itself, so that
+//// the positions of the lower orders never allocate, and it only moves to the heap when it grows beyond that. It
+//// has the small part of the deque interface the pos class used, with pointers as iterators.
+
+template <class Type, std::size_t N>
+class InlineStorage
+{
+public:
+  typedef Type value_type;
+  typedef std::size_t size_type;
+  typedef Type& reference;
+  typedef const Type& const_reference;
+  typedef Type* iterator;
+  typedef const Type* const_iterator;
+  typedef std::reverse_iterator<iterator> reverse_iterator;
+  typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+private:
+  std::array<Type, N> local;
+  std::unique_ptr<Type[]> heap;
+
+  Type * data_begin;
+  size_type length, capacity;
+
+  void assign(const Type * first, size_type count)
+  {
+    length = 0;
+    reserve(count);
+    std::copy(first, first + count, data_begin);
+    length = count;
+  };
+
+  void grow(size_type min_capacity)
+  {
+    size_type new_capacity = std::max(min_capacity, 2*capacity);
+    std::unique_ptr<Type[]> new_heap(new Type[new_capacity]);
+
+    std::copy(data_begin, data_begin + length, new_heap.get());
+
+    heap = std::move(new_heap);
+    data_begin = heap.get();
+    capacity = new_capacity;
+  };
+
+public:
+  InlineStorage() : length(0), capacity(N) {data_begin = local.data();};
+
+  InlineStorage(size_type count, const Type &value) : InlineStorage()
+  {
+    resize(count, value);
+  };
+
+  template <
+    class InputIterator,
+    typename = typename std::enable_if< !std::is_integral<InputIterator>::value >::type
+  >
+  InlineStorage(InputIterator first, InputIterator last) : InlineStorage()
+  {
+    for(; first != last; ++first)
+      push_back(*first);
+  };
+
+  InlineStorage(std::initializer_list<Type> l) : InlineStorage()
+  {
+    assign(l.begin(), l.size());
+  };
+
+  InlineStorage(const InlineStorage &rhs) : InlineStorage()
+  {
+    assign(rhs.data_begin, rhs.length);
+  };
+
+  InlineStorage(InlineStorage &&rhs) : InlineStorage()
+  {
+    *this = std::move(rhs);
+  };
+
+  InlineStorage& operator=(const InlineStorage &rhs)
+  {
+    if(this != &rhs)
+      assign(rhs.data_begin, rhs.length);
+
+    return *this;
+  };
+
+  InlineStorage& operator=(InlineStorage &&rhs)
+  {
+    if(this == &rhs)
+      return *this;
+
+    if(rhs.heap) {
+      heap = std::move(rhs.heap);
+      data_begin = heap.get();
+      length = rhs.length;
+      capacity = rhs.capacity;
+
+      rhs.data_begin = rhs.local.data();
+      rhs.capacity = N;
+    } else {
+      assign(rhs.data_begin, rhs.length);
+    }
+
+    rhs.length = 0;
+    return *this;
+  };
+
+  reference operator[](size_type index) {return data_begin[index];};
+  const_reference operator[](size_type index) const {return data_begin[index];};
+
+  reference at(size_type index)
+  {
+    if(index >= length)
+      throw std::out_of_range("InlineStorage::at");
+
+    return data_begin[index];
+  };
+
+  const_reference at(size_type index) const
+  {
+    if(index >= length)
+      throw std::out_of_range("InlineStorage::at");
+
+    return data_begin[index];
+  };
+
+  size_type size() const {return length;};
+  bool empty() const {return length == 0;};
+
+  iterator begin() {return data_begin;};
+  iterator end() {return data_begin + length;};
+  const_iterator begin() const {return data_begin;};
+  const_iterator end() const {return data_begin + length;};
+
+  reverse_iterator rbegin() {return reverse_iterator(end());};
+  reverse_iterator rend() {return reverse_iterator(begin());};
+  const_reverse_iterator rbegin() const {return const_reverse_iterator(end());};
+  const_reverse_iterator rend() const {return const_reverse_iterator(begin());};
+
+  void reserve(size_type new_capacity)
+  {
+    if(new_capacity > capacity)
+      grow(new_capacity);
+  };
+
+  void resize(size_type new_size, const Type &value)
+  {
+    reserve(new_size);
+
+    if(new_size > length)
+      std::fill(data_begin + length, data_begin + new_size, value);
+
+    length = new_size;
+  };
+
+  void push_back(const Type &value)
+  {
+    if(length == capacity)
+      grow(length + 1);
+
+    data_begin[length++] = value;
+  };
+
+  void push_front(const Type &value)
+  {
+    if(length == capacity)
+      grow(length + 1);
+
+    std::copy_backward(data_begin, data_begin + length, data_begin + length + 1);
+    data_begin[0] = value;
+    ++length;
+  };
+
+  void pop_front()
+  {
+    erase(begin());
+  };
+
+  iterator erase(iterator it)
+  {
+    std::copy(it + 1, end(), it);
+    --length;
+
+    return it;
+  };
+
+  iterator erase(iterator first, iterator last)
+  {
+    std::copy(last, end(), first);
+    length -= (last - first);
+
+    return first;
+  };
+};
+
+}
+
+#endif /* POSITION_STORAGE_HPP */
@@ -0,0 +1,187 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 11:20:14 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#ifndef TASK_POOL_HPP
+#define TASK_POOL_HPP
+
+#include<deque>
+#include<vector>
+#include<functional>
+#include<exception>
+
+#include<thread>
+#include<mutex>
+#include<condition_variable>
+
+namespace Utility {
+
+/*! \brief A small pool of worker threads executing tasks from a shared queue.
+ *
+ * Tasks are always submitted through a TaskPool::Group, which keeps track
+ * of how many of its tasks are still pending. Waiting on a group is not idle,
+ * the waiting thread executes queued tasks (of any group) until its own group
+ * is finished. This means tasks may themselves spawn and wait for new groups
+ * without dead-locking the pool, and that a pool of N threads only starts
+ * N-1 workers, as the thread calling Group::wait() is the N'th.
+ *
+ * Idle workers take the oldest task in the queue, while a waiting thread
+ * takes the newest, which for recursively split work means workers pick up
+ * the largest remaining subtrees.
+ *
+ * The class is written as a header only class.
+ */
+class TaskPool
+{
+public:
+	class Group;
+
+private:
+	struct Task
+	{
+		std::function<void()> work;
+		Group * group;
+	};
+
+	std::vector<std::thread> workers;
+	std::deque<Task> tasks;
+
+	std::mutex state_mutex;
+	std::condition_variable state_changed;
+	bool stopping;
+
+	/*! \brief Executes a single task with the lock released, and reports back to its group. */
+	void execute(Task task, std::unique_lock<std::mutex> & lock)
+	{
+		lock.unlock();
+
+		std::exception_ptr error;
+
+		try {
+			task.work();
+		} catch (...) {
+			error = std::current_exception();
+		}
+
+		lock.lock();
+
+		if(error and !task.group->error)
+			task.group->error = error;
+
+		--task.group->pending;
+		state_changed.notify_all();
+	};
+
+	void workerLoop()
+	{
+		std::unique_lock<std::mutex> lock(state_mutex);
+
+		while(true) {
+			state_changed.wait(lock, [this]() {return stopping or !tasks.empty();});
+
+			if(tasks.empty())
+				return;
+
+			Task task = std::move(tasks.front());
+			tasks.pop_front();
+
+			execute(std::move(task), lock);
+		}
+	};
+
+public:
+	/*! \brief A collection of tasks which can be waited for together.
+	 *
+	 * The first exception thrown by any of the tasks is re-thrown by wait().
+	 */
+	class Group
+	{
+	friend class TaskPool;
+
+	private:
+		TaskPool & pool;
+		std::size_t pending;
+		std::exception_ptr error;
+
+	public:
+		Group(TaskPool & pool) : pool(pool), pending(0) {};
+
+		Group(const Group &) = delete;
+		Group& operator=(const Group &) = delete;
+
+		/*! \brief Queue a new task belonging to this group. */
+		void run(std::function<void()> work)
+		{
+			std::lock_guard<std::mutex> lock(pool.state_mutex);
+
+			pool.tasks.push_back(Task{std::move(work), this});
+			++pending;
+
+			pool.state_changed.notify_one();
+		};
+
+		/*! \brief Wait until all tasks of the group are done, helping out in the meantime. */
+		void wait()
+		{
+			std::unique_lock<std::mutex> lock(pool.state_mutex);
+
+			while(pending != 0) {
+
+				if(pool.tasks.empty()) {
+					pool.state_changed.wait(lock);
+					continue;
+				}
+
+				Task task = std::move(pool.tasks.back());
+				pool.tasks.pop_back();
+
+				pool.execute(std::move(task), lock);
+			}
+
+			if(error) {
+				std::exception_ptr to_throw = error;
+				error = nullptr;
+				std::rethrow_exception(to_throw);
+			}
+		};
+
+		~Group()
+		{
+			try {
+				wait();
+			} catch (...) {}
+		};
+	};
+
+	/*! \brief Number of threads working on the tasks, including the waiting one. */
+	std::size_t size() const
+	{
+		return workers.size() + 1;
+	};
+
+	TaskPool(std::size_t number_of_threads) : stopping(false)
+	{
+		for(std::size_t i = 1; i < number_of_threads; ++i)
+			workers.emplace_back(&TaskPool::workerLoop, this);
+	};
+
+	TaskPool(const TaskPool &) = delete;
+	TaskPool& operator=(const TaskPool &) = delete;
+
+	~TaskPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(state_mutex);
+			stopping = true;
+		}
+
+		state_changed.notify_all();
+
+		for(std::thread & worker : workers)
+			worker.join();
+	};
+};
+
+} //Namespace Utility
+
+#endif /* TASK_POOL_HPP */
@@ -0,0 +1,86 @@
+/*
+ * Created: 17-10-2026
+ * Modified: Sat 17 Oct 2026 23:14:02 CEST
+ * Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+ */
+
+#include<position/position_kernels.hpp>
+#include<gtest/gtest.h>
+
+#include<vector>
+#include<random>
+
+#include"../utility_functions.hpp"
+
+using namespace Position;
+
+namespace {
+
+std::vector<int> RandomComponents(std::mt19937 &gen, std::size_t len)
+{
+  std::uniform_int_distribution<int> dist(-2,2);
+  std::vector<int> result(len);
+
+  for(int &x : result)
+    x = dist(gen);
+
+  return result;
+}
+
+}
+
+TEST(PositionKernelTest, AddAndSubtract)
+{
+  std::mt19937 gen(1234);
+
+  for(std::size_t len = 0; len < 14; ++len) {
+    auto lhs = RandomComponents(gen, len);
+    auto rhs = RandomComponents(gen, len);
+
+    auto sum_ref = lhs, sum = lhs;
+    Kernel::Scalar::add(sum_ref.data(), rhs.data(), len);
+    Kernel::add(sum.data(), rhs.data(), len);
+
+    EXPECT_PRED_FORMAT2(UnitTest::ContainerCompare, sum_ref, sum);
+
+    auto diff_ref = lhs, diff = lhs;
+    Kernel::Scalar::subtract(diff_ref.data(), rhs.data(), len);
+    Kernel::subtract(diff.data(), rhs.data(), len);
+
+    EXPECT_PRED_FORMAT2(UnitTest::ContainerCompare, diff_ref, diff);
+  }
+}
+
+TEST(PositionKernelTest, Mismatch)
+{
+  for(std::size_t len = 0; len < 14; ++len) {
+    auto lhs = std::vector<int>(len, 1);
+
+    EXPECT_EQ(len, Kernel::mismatch(lhs.data(), lhs.data(), len));
+
+    for(std::size_t i = 0; i < len; ++i) {
+      auto rhs = lhs;
+      rhs[i] = -1;
+
+      EXPECT_EQ(i, Kernel::Scalar::mismatch(lhs.data(), rhs.data(), len));
+      EXPECT_EQ(i, Kernel::mismatch(lhs.data(), rhs.data(), len));
+    }
+  }
+}
+
+TEST(PositionKernelTest, FirstNonZero)
+{
+  for(std::size_t len = 0; len < 14; ++len) {
+    auto x = std::vector<int>(len, 0);
+
+    EXPECT_EQ(len, Kernel::first_non_zero(x.data(), len));
+
+    for(std::size_t i = 0; i < len; ++i) {
+      auto y = x;
+      y[i] = 3;
+
+      EXPECT_EQ(i, Kernel::Scalar::first_non_zero(y.data(), len));
+      EXPECT_EQ(i, Kernel::first_non_zero(y.data(), len));
+    }
+  }
+}
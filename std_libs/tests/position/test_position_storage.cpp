@@ -0,0 +1,125 @@
+/*
+ * Created: 17-10-2026
+ * Modified: Sat 17 Oct 2026 22:41:15 CEST
+ * Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+ */
+
+#include<position/position_storage.hpp>
+#include<gtest/gtest.h>
+
+#include<vector>
+
+#include"../utility_functions.hpp"
+
+using namespace Position;
+
+typedef InlineStorage<int, 4> SmallStorage;
+
+TEST(PositionStorageTest, DefaultConstructor)
+{
+  auto s = SmallStorage{};
+
+  EXPECT_EQ(0L, s.size());
+  EXPECT_TRUE(s.empty());
+  EXPECT_EQ(s.begin(), s.end());
+}
+
+TEST(PositionStorageTest, LengthConstructor)
+{
+  auto v_ref = std::vector<int>(6,3);
+  auto s = SmallStorage(6,3);
+
+  EXPECT_EQ(6L, s.size());
+  EXPECT_PRED_FORMAT2(UnitTest::ContainerCompare, v_ref, s);
+}
+
+TEST(PositionStorageTest, GrowsPastInlineCapacity)
+{
+  auto v_ref = std::vector<int>{};
+  auto s = SmallStorage{};
+
+  for(int i = 0; i < 10; ++i) {
+    s.push_back(i);
+    v_ref.push_back(i);
+  }
+
+  EXPECT_EQ(10L, s.size());
+  EXPECT_PRED_FORMAT2(UnitTest::ContainerCompare, v_ref, s);
+
+  s.resize(3,0);
+  v_ref.resize(3);
+
+  EXPECT_EQ(3L, s.size());
+  EXPECT_PRED_FORMAT2(UnitTest::ContainerCompare, v_ref, s);
+}
+
+TEST(PositionStorageTest, CopyAndMove)
+{
+  auto v_short = std::vector<int>{1,2,3};
+  auto v_long = std::vector<int>{1,2,3,4,5,6,7};
+
+  for(const auto & v_ref : {v_short, v_long}) {
+    auto s = SmallStorage(v_ref.begin(), v_ref.end());
+
+    auto s_copy = s;
+    EXPECT_PRED_FORMAT2(UnitTest::ContainerCompare, v_ref, s_copy);
+    EXPECT_EQ(v_ref.size(), s_copy.size());
+
+    auto s_moved = std::move(s);
+    EXPECT_PRED_FORMAT2(UnitTest::ContainerCompare, v_ref, s_moved);
+    EXPECT_EQ(v_ref.size(), s_moved.size());
+    EXPECT_TRUE(s.empty());
+
+    s = s_moved;
+    EXPECT_PRED_FORMAT2(UnitTest::ContainerCompare, v_ref, s);
+
+    s_copy[0] = 9;
+    EXPECT_EQ(1, s[0]);
+    EXPECT_EQ(1, s_moved[0]);
+  }
+}
+
+TEST(PositionStorageTest, FrontOperations)
+{
+  auto s = SmallStorage{3,4};
+
+  s.push_front(2);
+  s.push_front(1);
+  s.push_front(0);
+
+  auto v_ref = std::vector<int>{0,1,2,3,4};
+  EXPECT_EQ(5L, s.size());
+  EXPECT_PRED_FORMAT2(UnitTest::ContainerCompare, v_ref, s);
+
+  s.pop_front();
+  s.pop_front();
+
+  v_ref = std::vector<int>{2,3,4};
+  EXPECT_EQ(3L, s.size());
+  EXPECT_PRED_FORMAT2(UnitTest::ContainerCompare, v_ref, s);
+}
+
+TEST(PositionStorageTest, Erase)
+{
+  auto s = SmallStorage{1,2,3,4,5,0,0};
+
+  s.erase(s.begin() + 1);
+
+  auto v_ref = std::vector<int>{1,3,4,5,0,0};
+  EXPECT_EQ(6L, s.size());
+  EXPECT_PRED_FORMAT2(UnitTest::ContainerCompare, v_ref, s);
+
+  s.erase(s.rbegin().base() - 2, s.end());
+
+  v_ref = std::vector<int>{1,3,4,5};
+  EXPECT_EQ(4L, s.size());
+  EXPECT_PRED_FORMAT2(UnitTest::ContainerCompare, v_ref, s);
+}
+
+TEST(PositionStorageTest, At)
+{
+  auto s = SmallStorage{1,2};
+
+  EXPECT_EQ(2, s.at(1));
+  EXPECT_THROW(s.at(2), std::out_of_range);
+}
@@ -0,0 +1,110 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 10:40:02 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#include"../necklaces.hpp"
+#include"../std_funcs.h"
+#include<gtest/gtest.h>
+
+#include<vector>
+#include<list>
+#include<set>
+#include<algorithm>
+
+TEST(NecklacesTest, Constructor)
+{
+  EXPECT_NO_THROW({
+      auto necklaces = FixedDensityNecklaces<>(4,2);
+  });
+
+  EXPECT_THROW({
+      auto necklaces = FixedDensityNecklaces<>(4,5);
+  }, std::invalid_argument);
+
+  EXPECT_THROW({
+      auto necklaces = FixedDensityNecklaces<>(4,-1);
+  }, std::invalid_argument);
+}
+
+TEST(NecklacesTest, EmptyLength)
+{
+  auto necklaces = FixedDensityNecklaces<>{0,0}.calculate();
+
+  EXPECT_TRUE(necklaces.empty());
+}
+
+TEST(NecklacesTest, ZeroDensity)
+{
+  auto necklaces = FixedDensityNecklaces<>{3,0}.calculate();
+
+  ASSERT_EQ(1L, necklaces.size());
+  EXPECT_EQ(std::vector<int>({0,0,0}), necklaces.front().word);
+  EXPECT_EQ(1, necklaces.front().multiplicity);
+}
+
+TEST(NecklacesTest, RunsFour)
+{
+  auto necklaces = FixedDensityNecklaces<>{4,2}.calculate();
+
+  ASSERT_EQ(2L, necklaces.size());
+
+  EXPECT_EQ(std::vector<int>({0,0,1,1}), necklaces.front().word);
+  EXPECT_EQ(4, necklaces.front().multiplicity);
+
+  EXPECT_EQ(std::vector<int>({0,1,0,1}), necklaces.back().word);
+  EXPECT_EQ(2, necklaces.back().multiplicity);
+}
+
+TEST(NecklacesTest, RunsSix)
+{
+  auto necklaces = FixedDensityNecklaces<>{6,3}.calculate();
+
+  auto expected = std::list< std::vector<int> > {
+    {0,0,0,1,1,1},
+    {0,0,1,0,1,1},
+    {0,0,1,1,0,1},
+    {0,1,0,1,0,1} };
+
+  auto expected_mult = std::vector<int>{6,6,6,2};
+
+  ASSERT_EQ(expected.size(), necklaces.size());
+
+  auto exp_it = expected.begin();
+  int i = 0;
+  for(const auto & n : necklaces) {
+    EXPECT_EQ(*exp_it, n.word);
+    EXPECT_EQ(expected_mult[i], n.multiplicity);
+    ++exp_it; ++i;
+  }
+}
+
+/// Rotating every necklace through its multiplicity must reproduce every string of the given
+/// density exactly once
+
+TEST(NecklacesTest, CoversAllRotations)
+{
+  for(int len = 2; len <= 12; len += 2) {
+
+    auto necklaces = FixedDensityNecklaces<>{len,len/2}.calculate();
+
+    std::set< std::vector<int> > all_words;
+    int total = 0;
+
+    for(const auto & n : necklaces) {
+      auto word = n.word;
+
+      for(int r = 0; r < n.multiplicity; ++r) {
+        all_words.insert(word);
+        std::rotate(word.begin(), word.begin()+1, word.end());
+      }
+
+      EXPECT_EQ(n.word, word);
+      total += n.multiplicity;
+    }
+
+    int n_words = Utility::BinomialCoefficients<int>(len, len/2);
+
+    EXPECT_EQ(n_words, total);
+    EXPECT_EQ((size_t)n_words, all_words.size());
+  }
+}
@@ -0,0 +1,101 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 11:48:51 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#include"../task_pool.hpp"
+#include<gtest/gtest.h>
+
+#include<vector>
+#include<atomic>
+#include<stdexcept>
+
+using Utility::TaskPool;
+
+TEST(TaskPoolTest, Constructor)
+{
+  TaskPool single(1);
+  EXPECT_EQ(1L, single.size());
+
+  TaskPool many(4);
+  EXPECT_EQ(4L, many.size());
+}
+
+TEST(TaskPoolTest, SingleThreadRunsOnWait)
+{
+  TaskPool pool(1);
+  TaskPool::Group group(pool);
+
+  int counter = 0;
+
+  for(int i = 0; i < 10; ++i)
+    group.run([&counter]() {++counter;});
+
+  EXPECT_EQ(0, counter);
+
+  group.wait();
+
+  EXPECT_EQ(10, counter);
+}
+
+TEST(TaskPoolTest, AllTasksRun)
+{
+  TaskPool pool(4);
+  TaskPool::Group group(pool);
+
+  std::vector<int> results(1000, 0);
+
+  for(int i = 0; i < 1000; ++i)
+    group.run([&results, i]() {results[i] = i*i;});
+
+  group.wait();
+
+  for(int i = 0; i < 1000; ++i)
+    ASSERT_EQ(i*i, results[i]);
+}
+
+long NestedSum(TaskPool & pool, int from, int to)
+{
+  if(to - from < 8) {
+    long sum = 0;
+    for(int i = from; i < to; ++i)
+      sum += i;
+    return sum;
+  }
+
+  int mid = (from + to)/2;
+  long lower, upper;
+
+  TaskPool::Group group(pool);
+  group.run([&]() {lower = NestedSum(pool, from, mid);});
+  group.run([&]() {upper = NestedSum(pool, mid, to);});
+  group.wait();
+
+  return lower + upper;
+}
+
+TEST(TaskPoolTest, NestedGroups)
+{
+  TaskPool pool(4);
+
+  EXPECT_EQ(499500L, NestedSum(pool, 0, 1000));
+}
+
+TEST(TaskPoolTest, ExceptionPropagates)
+{
+  TaskPool pool(3);
+  TaskPool::Group group(pool);
+
+  std::atomic<int> counter(0);
+
+  for(int i = 0; i < 20; ++i)
+    group.run([&counter, i]() {
+        ++counter;
+        if(i == 7)
+          throw std::runtime_error("task failed");
+    });
+
+  EXPECT_THROW(group.wait(), std::runtime_error);
+  EXPECT_EQ(20, counter.load());
+
+  EXPECT_NO_THROW(group.wait());
+}
@@ -0,0 +1,38 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 21:02:17 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#include"temporal_memo.hpp"
+
+namespace hop {
+
+std::shared_ptr<const TemporalMemo::Entry> TemporalMemo::find(const std::string & key) const
+{
+  std::lock_guard<std::mutex> lock(table_mutex);
+
+  auto it = table.find(key);
+  return (it != table.end()) ? it->second : nullptr;
+}
+
+std::shared_ptr<const TemporalMemo::Entry> TemporalMemo::insert(const std::string & key, Entry && entry)
+{
+  std::shared_ptr<const Entry> new_entry = std::make_shared<Entry>(std::move(entry));
+
+  std::lock_guard<std::mutex> lock(table_mutex);
+
+  return table.emplace(key, new_entry).first->second;
+}
+
+std::size_t TemporalMemo::size() const
+{
+  std::lock_guard<std::mutex> lock(table_mutex);
+  return table.size();
+}
+
+void TemporalMemo::clear()
+{
+  std::lock_guard<std::mutex> lock(table_mutex);
+  table.clear();
+}
+
+} //Namespace hop
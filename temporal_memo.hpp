@@ -0,0 +1,54 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 21:02:17 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#ifndef TEMPORAL_MEMO_HPP
+#define TEMPORAL_MEMO_HPP
+
+#include<string>
+#include<vector>
+#include<unordered_map>
+#include<memory>
+#include<mutex>
+#include<cstdint>
+
+namespace hop {
+
+//// A table of the temporal links of p/m substrings, shared by all configurations. The key is the substring with
+//// a '.' after every trace end, e.g. "pmpm.pm.", and an entry holds every valid way of linking the substring, in the
+//// order the temporal recursion finds them. The links are stored back to back in a single array, with the link ids
+//// counted from 1 at the start of the substring and the sign telling p (+) from m (-).
+////
+//// The table is filled and read from several threads. An entry is never changed once it is inserted, and the lookup
+//// hands out a shared pointer, so the links can be read without holding the lock.
+
+class TemporalMemo
+{
+public:
+  struct Entry
+  {
+    int length;
+    std::vector<std::int8_t> links;
+
+    std::size_t size() const {return (length > 0) ? links.size()/length : 0;};
+    const std::int8_t * operator[](std::size_t k) const {return links.data() + k*length;};
+  };
+
+private:
+  std::unordered_map< std::string, std::shared_ptr<const Entry> > table;
+  mutable std::mutex table_mutex;
+
+public:
+  //// Returns a nullptr if the key has not been inserted
+  std::shared_ptr<const Entry> find(const std::string & key) const;
+
+  //// Inserts the entry unless another thread got there first, and returns the one in the table
+  std::shared_ptr<const Entry> insert(const std::string & key, Entry && entry);
+
+  std::size_t size() const;
+  void clear();
+};
+
+} //Namespace hop
+
+#endif /* TEMPORAL_MEMO_HPP */
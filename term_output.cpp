@@ -0,0 +1,43 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 15:32:08 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#include"term_output.hpp"
+
+#include<fstream>
+
+#include<sys/types.h>
+#include<sys/stat.h>
+
+#include"debug_printer.hpp"
+#include"json_printer.hpp"
+#include"std_libs/position/position_default_io.hpp"
+
+namespace hop {
+
+void MakeOutputFolder(const std::string & foldername)
+{
+  struct stat st {0};
+  if(stat(foldername.c_str(), &st) == -1)
+    mkdir(foldername.c_str(), 0755);
+}
+
+void PrintTermFiles(const std::string & file_base, const std::list<WilsonString> & terms)
+{
+  std::ofstream out(file_base + ".terms");
+  DebugPrinter term_printer(out, new Position::SymbolPrinter(out));
+
+  for(const WilsonString & w : terms)
+    w.print(term_printer);
+
+  out.close();
+
+  JSONPrinter json_printer;
+
+  for(const WilsonString & ws : terms)
+    ws.print(json_printer);
+
+  json_printer.WriteToFile(file_base + ".json");
+}
+
+} //Namespace hop
@@ -0,0 +1,23 @@
+//Created: 17-10-2026
+//Modified: Sat 17 Oct 2026 15:32:08 CEST
+//Author: Jonas R. Glesaaen (jonas@glesaaen.com)
+
+#ifndef TERM_OUTPUT_HPP
+#define TERM_OUTPUT_HPP
+
+#include<string>
+#include<list>
+
+#include"pm.wilson.h"
+
+namespace hop {
+
+//// Creates the output folder if it doesn't already exist
+void MakeOutputFolder(const std::string & foldername);
+
+//// Prints the final collected terms to file_base + ".terms" and file_base + ".json"
+void PrintTermFiles(const std::string & file_base, const std::list<WilsonString> & terms);
+
+} //Namespace hop
+
+#endif /* TERM_OUTPUT_HPP */